@@ -0,0 +1,273 @@
+#ifndef ARROW_WRITER_H
+#define ARROW_WRITER_H
+
+// Columnar binary output in the Arrow IPC stream format (https://arrow.apache.org/docs/format/Columnar.html),
+// so that a consumer loads typed columns with memcpy instead of parsing text.
+// Each sheet is one complete stream: schema message, one record batch, end-of-stream marker. Sheets follow each other.
+// Every spreadsheet column becomes a nullable field named by its letters ("A", "B", ..., "AA"), with row N of the sheet
+// as row N of the batch; empty cells are null. The field type is inferred from the typed cell values (cellValue.h):
+// float64 (float, percentage, currency), bool, timestamp[us] (date), duration[us] (time). Columns with text, or with
+// more than one of those, are utf8. The schema carries the sheet name as metadata "sheet".
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "cellValue.h"
+#include "flatBuilder.h"
+#include "outSink.h"
+#include "sheet.h"
+
+// spreadsheet letters of column "ixCol": 0 is "A", 25 "Z", 26 "AA"
+inline std::string columnName(size_t ixCol) {
+    std::string name;
+    for (size_t n = ixCol + 1; n > 0; n = (n - 1) / 26)
+        name.insert(name.begin(), 'A' + (n - 1) % 26);
+    return name;
+}
+
+class ArrowWriter {
+   public:
+    // "values": utf8 columns hold the typed value as text (see appendTypedValue()) where a cell has one, as with --values
+    ArrowWriter(OutSink& out, bool values) : out(out), values(values) {}
+
+    void writeSheet(const std::string& name, const Sheet& sheet) {
+        // === extent ===
+        size_t nRows = 0;
+        size_t nCols = 0;
+        for (size_t ixRun = 0; ixRun < sheet.nRowRuns(); ++ixRun) {
+            nRows = std::max(nRows, sheet.getIxRow(ixRun) + sheet.getNRowRep(ixRun));
+            for (size_t ixCell = sheet.cellBegin(ixRun); ixCell < sheet.cellEnd(ixRun); ++ixCell)
+                nCols = std::max(nCols, sheet.getIxCol(ixCell) + sheet.getNColRep(ixCell));
+        }
+
+        // === column types: which value types occur in each column ===
+        std::vector<unsigned> seen(nCols, 0);  // bit per valueType_e
+        for (size_t ixCell = 0; ixCell < sheet.cellBegin(sheet.nRowRuns()); ++ixCell)
+            for (size_t ixCol = sheet.getIxCol(ixCell); ixCol < sheet.getIxCol(ixCell) + sheet.getNColRep(ixCell); ++ixCol)
+                seen[ixCol] |= 1u << sheet.getValue(ixCell).type;
+        columns.resize(nCols);
+        for (size_t ixCol = 0; ixCol < nCols; ++ixCol)
+            initColumn(columns[ixCol], typeOf(seen[ixCol]), nRows);
+
+        // === fill, expanding repeated rows and cells ===
+        for (size_t ixRun = 0; ixRun < sheet.nRowRuns(); ++ixRun)
+            for (size_t ixRow = sheet.getIxRow(ixRun); ixRow < sheet.getIxRow(ixRun) + sheet.getNRowRep(ixRun); ++ixRow)
+                for (size_t ixCell = sheet.cellBegin(ixRun); ixCell < sheet.cellEnd(ixRun); ++ixCell) {
+                    const std::string_view text = sheet.getText(ixCell);
+                    const TypedValue value = sheet.getValue(ixCell);
+                    for (size_t ixCol = sheet.getIxCol(ixCell); ixCol < sheet.getIxCol(ixCell) + sheet.getNColRep(ixCell); ++ixCol)
+                        setCell(columns[ixCol], ixRow, text, value);
+                }
+        for (size_t ixCol = 0; ixCol < nCols; ++ixCol)
+            if (columns[ixCol].type == AT_UTF8) padOffsets(columns[ixCol], nRows);
+
+        putMessage(schemaMessage(name, nCols));
+        writeRecordBatch(nRows, nCols);
+        put<uint32_t>(0xFFFFFFFF);  // end of stream
+        put<uint32_t>(0);
+    }
+
+   protected:
+    enum arrowType_e {
+        AT_UTF8,
+        AT_FLOAT64,
+        AT_BOOL,
+        AT_TIMESTAMP,  // microseconds since 1970-01-01, no time zone
+        AT_DURATION    // microseconds
+    };
+
+    struct column_t {
+        arrowType_e type = AT_UTF8;
+        std::string validity;          // bit per row, set: not null
+        std::string data;              // fixed width values, bits (bool) or the UTF-8 bytes of all rows
+        std::vector<int32_t> offsets;  // utf8: row N is [offsets[N], offsets[N + 1]) in "data"
+        size_t nValid = 0;
+    };
+
+    static arrowType_e typeOf(unsigned seen) {
+        const unsigned numeric = 1u << VT_FLOAT | 1u << VT_PERCENTAGE | 1u << VT_CURRENCY;
+        if (seen != 0 && (seen & ~numeric) == 0) return AT_FLOAT64;
+        if (seen == 1u << VT_BOOLEAN) return AT_BOOL;
+        if (seen == 1u << VT_DATE) return AT_TIMESTAMP;
+        if (seen == 1u << VT_TIME) return AT_DURATION;
+        return AT_UTF8;  // text, mixed, or no cells at all
+    }
+
+    static void initColumn(column_t& col, arrowType_e type, size_t nRows) {
+        col.type = type;
+        col.validity.assign((nRows + 7) / 8, 0);
+        col.nValid = 0;
+        col.data.clear();
+        col.offsets.assign(1, 0);
+        if (type == AT_BOOL)
+            col.data.assign((nRows + 7) / 8, 0);
+        else if (type != AT_UTF8)
+            col.data.assign(nRows * 8, 0);
+    }
+
+    void setCell(column_t& col, size_t ixRow, std::string_view text, const TypedValue& value) {
+        col.validity[ixRow / 8] |= 1 << ixRow % 8;
+        ++col.nValid;
+        switch (col.type) {
+            case AT_FLOAT64:
+                memcpy(&col.data[ixRow * 8], &value.num, 8);
+                break;
+            case AT_BOOL:
+                if (value.num != 0) col.data[ixRow / 8] |= 1 << ixRow % 8;
+                break;
+            case AT_TIMESTAMP:
+            case AT_DURATION: {
+                const int64_t us = std::llround(value.num * 1e6);
+                memcpy(&col.data[ixRow * 8], &us, 8);
+                break;
+            }
+            case AT_UTF8:
+                padOffsets(col, ixRow);
+                if (values && value.type != VT_STRING) {
+                    valueText.clear();
+                    appendTypedValue(valueText, value);
+                    text = valueText;
+                }
+                col.data += text;
+                if (col.data.size() > INT32_MAX) throw std::runtime_error("text of a column exceeds 2 GB, too large for Arrow utf8");
+                col.offsets.push_back(col.data.size());
+                break;
+        }
+    }
+
+    // ends the rows before "ixRow" that have no text yet as empty
+    static void padOffsets(column_t& col, size_t ixRow) {
+        col.offsets.resize(ixRow + 1, col.data.size());
+    }
+
+    // === IPC framing: continuation marker, metadata size, metadata (a multiple of 8 bytes), then the body ===
+
+    template <class T>
+    void put(T value) {
+        out.put(std::string_view((const char*)&value, sizeof(T)));
+    }
+
+    void putMessage(const std::string& metadata) {
+        put<uint32_t>(0xFFFFFFFF);
+        put<int32_t>(metadata.size());
+        out.put(metadata);
+    }
+
+    // Message table of Message.fbs around "header" of type "headerType" (1: Schema, 3: RecordBatch)
+    static std::string message(FlatBuilder& fb, uint8_t headerType, FlatBuilder::ref_t header, int64_t bodyLength) {
+        fb.startTable();
+        fb.add<int64_t>(3, bodyLength);
+        fb.addRef(2, header);
+        fb.add<int16_t>(0, 4);  // MetadataVersion V5
+        fb.add<uint8_t>(1, headerType);
+        return fb.finish(fb.endTable());
+    }
+
+    std::string schemaMessage(const std::string& sheetName, size_t nCols) {
+        FlatBuilder fb;
+
+        // === one Field per column ===
+        std::vector<FlatBuilder::ref_t> fields;
+        for (size_t ixCol = 0; ixCol < nCols; ++ixCol) {
+            const FlatBuilder::ref_t name = fb.string(columnName(ixCol));
+            const FlatBuilder::ref_t children = fb.refs({});
+            uint8_t typeId = 0;  // Type union of Schema.fbs
+            fb.startTable();
+            switch (columns[ixCol].type) {
+                case AT_UTF8: typeId = 5; break;
+                case AT_BOOL: typeId = 6; break;
+                case AT_FLOAT64:
+                    typeId = 3;
+                    fb.add<int16_t>(0, 2);  // FloatingPoint precision DOUBLE
+                    break;
+                case AT_TIMESTAMP:
+                    typeId = 10;
+                    fb.add<int16_t>(0, 2);  // unit MICROSECOND
+                    break;
+                case AT_DURATION:
+                    typeId = 18;
+                    fb.add<int16_t>(0, 2);  // unit MICROSECOND
+                    break;
+            }
+            const FlatBuilder::ref_t type = fb.endTable();
+
+            fb.startTable();
+            fb.addRef(0, name);
+            fb.addRef(3, type);
+            fb.addRef(5, children);
+            fb.add<uint8_t>(1, 1);  // nullable
+            fb.add<uint8_t>(2, typeId);
+            fields.push_back(fb.endTable());
+        }
+        const FlatBuilder::ref_t fieldVector = fb.refs(fields);
+
+        // === custom metadata: the sheet name ===
+        const FlatBuilder::ref_t key = fb.string("sheet");
+        const FlatBuilder::ref_t value = fb.string(sheetName);
+        fb.startTable();
+        fb.addRef(0, key);
+        fb.addRef(1, value);
+        const FlatBuilder::ref_t metadata = fb.refs({fb.endTable()});
+
+        fb.startTable();
+        fb.addRef(1, fieldVector);
+        fb.addRef(2, metadata);
+        fb.add<int16_t>(0, 0);  // little endian
+        return message(fb, 1, fb.endTable(), 0);
+    }
+
+    void writeRecordBatch(size_t nRows, size_t nCols) {
+        // === body layout: per column validity, [offsets,] data; each buffer padded to 8 bytes ===
+        struct fieldNode_t {
+            int64_t length;
+            int64_t nullCount;
+        };
+        struct buffer_t {
+            int64_t offset;
+            int64_t length;
+        };
+        std::vector<fieldNode_t> nodes;
+        std::vector<buffer_t> buffers;
+        std::vector<std::string_view> body;
+        int64_t bodyLength = 0;
+        auto addBuffer = [&](const void* p, size_t n) {
+            buffers.push_back({bodyLength, (int64_t)n});
+            body.push_back(std::string_view((const char*)p, n));
+            bodyLength += (n + 7) / 8 * 8;
+        };
+        for (size_t ixCol = 0; ixCol < nCols; ++ixCol) {
+            const column_t& col = columns[ixCol];
+            nodes.push_back({(int64_t)nRows, (int64_t)(nRows - col.nValid)});
+            addBuffer(col.validity.data(), col.validity.size());
+            if (col.type == AT_UTF8) addBuffer(col.offsets.data(), col.offsets.size() * 4);
+            addBuffer(col.data.data(), col.data.size());
+        }
+
+        FlatBuilder fb;
+        const FlatBuilder::ref_t nodeVector = fb.structs(nodes.data(), nodes.size(), sizeof(fieldNode_t), 8);
+        const FlatBuilder::ref_t bufferVector = fb.structs(buffers.data(), buffers.size(), sizeof(buffer_t), 8);
+        fb.startTable();
+        fb.add<int64_t>(0, nRows);
+        fb.addRef(1, nodeVector);
+        fb.addRef(2, bufferVector);
+        putMessage(message(fb, 3, fb.endTable(), bodyLength));
+
+        static const char zeros[8] = {};
+        for (const std::string_view& b : body) {
+            out.put(b);
+            out.put(std::string_view(zeros, (8 - b.size() % 8) % 8));
+        }
+    }
+
+    OutSink& out;
+    const bool values;
+    std::vector<column_t> columns;  // of the sheet being written, reused
+    std::string valueText;          // typed value as text, reused
+};
+
+#endif
@@ -0,0 +1,56 @@
+// Inflating a whole member into one buffer: unzReadCurrentFile, which refills a 16 KB read buffer and calls inflate()
+// per refill, versus unzReadCurrentFileAll, one read and one inflate(Z_FINISH) call (as unzipToBuf() does), each via
+// stdio and via mmap. Meant for members of 50 to 500 MB, where the per-refill overhead adds up.
+// Usage: inflateBench.exe file.ods [member] [nRounds]. Build and run: make bench ODS=file.ods
+
+#define ODS2CSV_NO_MAIN
+#include "../main.cpp"
+
+#include <chrono>
+
+int main(int argc, const char** argv) {
+    const string fname = argc > 1 ? argv[1] : "sampleInput.ods";
+    const string member = argc > 2 ? argv[2] : "content.xml";
+    const size_t nRounds = argc > 3 ? std::atol(argv[3]) : 3;
+
+    size_t length = 0;
+    free(unzipToBuf(fname.c_str(), member.c_str(), false, &length));  // also warms the page cache
+    const double mb = length / 1e6;
+    std::cerr << fname << ": " << member << " " << mb << " MB, best of " << nRounds << endl;
+
+    // === best of "nRounds" ===
+    auto run = [&](const string& what, const std::function<size_t()>& inflateAll) {
+        double best = 1e30;
+        for (size_t ixRound = 0; ixRound < nRounds; ++ixRound) {
+            const auto t0 = std::chrono::steady_clock::now();
+            if (inflateAll() != length) throw runtime_error(what + " failed for '" + fname + "'");
+            best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count());
+        }
+        std::cerr << what << ": " << best << " s, " << mb / best << " MB/s" << endl;
+    };
+
+    for (bool mmapped : {false, true}) {
+        const string io = mmapped ? "mmap" : "stdio";
+        run("unzReadCurrentFile, " + io, [&] {
+            unz_file_info64 info;
+            UnzHandle uf = openMember(fname.c_str(), member.c_str(), mmapped, &info);
+            if (!uf) return (size_t)0;
+            std::unique_ptr<char, void (*)(void*)> buf((char*)malloc(info.uncompressed_size + 1), free);
+            size_t nRead = 0;
+            while (1) {
+                const size_t nWant = std::min<size_t>(info.uncompressed_size + 1 - nRead, 1 << 30);
+                const int nBytes = unzReadCurrentFile(uf.get(), buf.get() + nRead, nWant);
+                if (nBytes < 0) return (size_t)0;
+                if (nBytes == 0) break;
+                nRead += nBytes;
+            }
+            return unzCloseCurrentFile(uf.get()) == UNZ_OK ? nRead : 0;
+        });
+        run("unzReadCurrentFileAll, " + io, [&] {
+            size_t n = 0;
+            std::unique_ptr<char, void (*)(void*)> buf(unzipToBuf(fname.c_str(), member.c_str(), mmapped, &n), free);
+            return buf ? n : 0;
+        });
+    }
+    return 0;
+}
@@ -0,0 +1,99 @@
+// Output stage throughput: per-token iostream writer (as in the original main()) versus SheetWriter on OutSink,
+// in the legacy format and as RFC 4180 CSV (quoting test on every field).
+// Writes a synthetic wide, sparse sheet to stdout (redirect to /dev/null), reports MB/s on stderr.
+// Build and run: make bench
+
+#define ODS2CSV_NO_MAIN
+#include "../main.cpp"
+
+#include <chrono>
+
+// the original output loop: one cout << per token, including each separator of a skipped empty column
+void writeTablePerToken(const string& name, const Sheet& table, const string& sepCol, const string& sepRow) {
+    std::cout << "$NEW_SHEET," << name << sepRow;
+    size_t lastTerminatedIxRow = 0;
+    for (size_t ixRun = 0; ixRun < table.nRowRuns(); ++ixRun) {
+        for (size_t ixRep = 0; ixRep < table.getNRowRep(ixRun); ++ixRep) {
+            const size_t ixRow = table.getIxRow(ixRun) + ixRep;
+            for (size_t ix = lastTerminatedIxRow; ix < ixRow; ++ix)
+                std::cout << sepRow;
+            lastTerminatedIxRow = ixRow;
+            size_t lastTerminatedIxCol = 0;
+            for (size_t ixCell = table.cellBegin(ixRun); ixCell < table.cellEnd(ixRun); ++ixCell) {
+                for (size_t ixColRep = 0; ixColRep < table.getNColRep(ixCell); ++ixColRep) {
+                    const size_t ixCol = table.getIxCol(ixCell) + ixColRep;
+                    for (size_t ix = lastTerminatedIxCol; ix < ixCol; ++ix)
+                        std::cout << sepCol;
+                    lastTerminatedIxCol = ixCol;
+                    std::cout << table.getText(ixCell);
+                }
+            }
+            std::cout << sepRow;
+        }
+    }
+    std::cout << "$END_SHEET" << sepRow;
+}
+
+int main() {
+    const string sepCol(",");
+    const string sepRow("\n");
+
+    // === 20000 rows of 1000 columns, every 8th cell filled; every 10th row is a run of 3 ===
+    Sheet table;
+    size_t ixRow = 0;
+    for (size_t ixRun = 0; ixRun < 20000; ++ixRun) {
+        const size_t nRep = ixRun % 10 == 0 ? 3 : 1;
+        table.beginRow(ixRow, nRep);
+        for (size_t ixCol = ixRun % 8; ixCol < 1000; ixCol += 8)
+            table.addCell(ixCol, 1, std::to_string(ixRun * 1000 + ixCol));
+        table.endRow();
+        ixRow += nRep + ixRun % 2;  // some empty rows in between
+    }
+
+    CsvDialect csv;
+    csv.legacy = false;
+
+    // === output size ===
+    auto outputSize = [&](const CsvDialect& dialect) {
+        string expected;
+        OutSink out(&expected);
+        SheetWriter writer(out, dialect);
+        writeTable(writer, "bench", table);
+        out.close();
+        return expected.size() / 1e6;
+    };
+    double mb = outputSize(CsvDialect());
+
+    auto report = [&](const char* what, std::chrono::steady_clock::time_point t0) {
+        const double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        std::cerr << what << ": " << mb << " MB in " << s << " s, " << mb / s << " MB/s" << endl;
+    };
+
+    // === before: synchronized iostreams, per token ===
+    auto t0 = std::chrono::steady_clock::now();
+    writeTablePerToken("bench", table, sepCol, sepRow);
+    std::cout.flush();
+    report("iostream per token", t0);
+
+    // === after: OutSink ===
+    t0 = std::chrono::steady_clock::now();
+    {
+        OutSink out(STDOUT_FILENO);
+        SheetWriter writer(out, CsvDialect());
+        writeTable(writer, "bench", table);
+        out.close();
+    }
+    report("OutSink           ", t0);
+
+    // === after: OutSink, RFC 4180 ===
+    mb = outputSize(csv);
+    t0 = std::chrono::steady_clock::now();
+    {
+        OutSink out(STDOUT_FILENO);
+        SheetWriter writer(out, csv);
+        writeTable(writer, "bench", table);
+        out.close();
+    }
+    report("OutSink, --csv    ", t0);
+    return 0;
+}
@@ -0,0 +1,71 @@
+// Tokenizer throughput on content.xml of a workbook: tinyxml2 XMLDocument::Parse (DOM) versus OdsSaxParser,
+// with each byte scanner of xmlScan.h (scalar, SSE2, AVX2). content.xml is inflated once, beforehand.
+// Usage: saxBench.exe file.ods [nRounds]. Build and run: make bench ODS=file.ods
+
+#define ODS2CSV_NO_MAIN
+#include "../main.cpp"
+
+#include <chrono>
+
+// counts cells, so the events are not optimized away
+class CountingHandler : public OdsSaxHandler {
+   public:
+    void tableStart(const string&) override {}
+    void tableEnd() override {}
+    void rowStart(size_t) override {}
+    void rowEnd() override {}
+    void cell(const string& text, const TypedValue&, size_t) override {
+        ++nCells;
+        nTextBytes += text.size();
+    }
+
+    size_t nCells = 0;
+    size_t nTextBytes = 0;
+};
+
+int main(int argc, const char** argv) {
+    const string fname = argc > 1 ? argv[1] : "sampleInput.ods";
+    const size_t nRounds = argc > 2 ? std::atol(argv[2]) : 3;
+
+    size_t lengthOfXmlData;
+    std::unique_ptr<char, void (*)(void*)> xml(unzipToBuf(fname.c_str(), "content.xml", false, &lengthOfXmlData), free);
+    if (!xml) throw runtime_error(string("unzip failed for '") + fname + "'");
+    const double mb = lengthOfXmlData / 1e6;
+    std::cerr << fname << ": content.xml " << mb << " MB, best of " << nRounds << endl;
+
+    // === best of "nRounds" ===
+    auto run = [&](const string& what, const std::function<void()>& parse) {
+        double best = 1e30;
+        for (size_t ixRound = 0; ixRound < nRounds; ++ixRound) {
+            const auto t0 = std::chrono::steady_clock::now();
+            parse();
+            best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count());
+        }
+        std::cerr << what << ": " << best << " s, " << mb / best << " MB/s" << endl;
+    };
+
+    run("tinyxml2 XMLDocument::Parse", [&] {
+        XMLDocument doc;
+        if (doc.Parse(xml.get(), lengthOfXmlData) != XML_SUCCESS) throw runtime_error("XML parse failed");
+    });
+
+    vector<std::pair<string, findAnyFun_t>> scanners = {{"scalar", findAnyScalar}};
+#ifdef XML_SCAN_X86
+    scanners.push_back({"SSE2", findAnySse2});
+    if (__builtin_cpu_supports("avx2")) scanners.push_back({"AVX2", findAnyAvx2});
+#endif
+    size_t nCells = 0;
+    for (const auto& scanner : scanners) {
+        findAnyImpl = scanner.second;
+        run("OdsSaxParser, " + scanner.first + " scan", [&] {
+            CountingHandler h;
+            OdsSaxParser parser(h);
+            parser.feed(xml.get(), lengthOfXmlData);
+            parser.finish();
+            nCells = h.nCells;
+        });
+    }
+    findAnyImpl = selectFindAny();
+    std::cerr << nCells << " cells" << endl;
+    return 0;
+}
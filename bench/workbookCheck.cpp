@@ -0,0 +1,86 @@
+// Consistency check of class Workbook: opens one workbook from a file via stdio, via mmap and from a buffer in memory
+// (Workbook::fromMemory), and checks that the three give the same answers: sheet names, sheets (also against
+// ods2txt_sparse), a range of each sheet, text and value of every cell, and the inflated members.
+// Usage: workbookCheck.exe file.ods [range] [member]. Build and run: make test
+// Prints the sheet count on success; mismatches go to stderr, with exit code 1.
+
+#define ODS2CSV_NO_MAIN
+#include "../main.cpp"
+
+// sheet in the legacy text format, for comparing whole sheets
+string render(const string& name, const Sheet& table) {
+    string r;
+    OutSink out(&r);
+    SheetWriter writer(out, CsvDialect());
+    writeTable(writer, name, table);
+    out.close();
+    return r;
+}
+
+int main(int argc, const char** argv) {
+    const string fname = argc > 1 ? argv[1] : "sampleInput.ods";
+    const CellRange range = CellRange::parse(argc > 2 ? argv[2] : "B2:D5");
+    const string memberName = argc > 3 ? argv[3] : "content.xml";
+
+    std::ifstream file(fname, std::ios::binary);
+    if (!file) throw runtime_error("cannot read '" + fname + "'");
+    const string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    Workbook stdio(fname);
+    Workbook mapped(fname, /*mmapped*/ true);
+    Workbook inMemory = Workbook::fromMemory(bytes.data(), bytes.size());
+    Workbook* const books[] = {&stdio, &mapped, &inMemory};
+    const char* const bookNames[] = {"stdio", "mmap", "memory"};
+
+    size_t nFailed = 0;
+    auto check = [&](bool ok, const string& what) {
+        if (!ok) {
+            std::cerr << "workbookCheck: " << fname << ": " << what << endl;
+            ++nFailed;
+        }
+    };
+
+    // === sheets: each source against stdio, stdio against the converter ===
+    const vector<string>& names = stdio.sheetNames();
+    const map<string, Sheet> converted = ods2txt_sparse(fname, false);
+    check(converted.size() == names.size(), "sheet count differs from ods2txt_sparse");
+    for (const string& name : names) {
+        const Sheet& expected = stdio.sheet(name);
+        const auto it = converted.find(name);
+        check(it != converted.end() && render(name, it->second) == render(name, expected), "sheet '" + name + "' differs from ods2txt_sparse");
+        check(&stdio.sheet(name) == &expected, "sheet '" + name + "' parsed twice");
+        const string expectedRange = render(name, stdio.range(name, range));
+
+        for (size_t ixBook = 1; ixBook < 3; ++ixBook) {
+            Workbook& book = *books[ixBook];
+            const string where = string(bookNames[ixBook]) + ": sheet '" + name + "'";
+            check(book.sheetNames() == names, string(bookNames[ixBook]) + ": sheet names differ");
+            check(render(name, book.sheet(name)) == render(name, expected), where + " differs");
+            check(render(name, book.range(name, range)) == expectedRange, where + ": range differs");
+
+            // === every cell, through the point queries ===
+            for (size_t ixRun = 0; ixRun < expected.nRowRuns(); ++ixRun) {
+                const size_t ixRow = expected.getIxRow(ixRun);
+                for (size_t ixCell = expected.cellBegin(ixRun); ixCell < expected.cellEnd(ixRun); ++ixCell) {
+                    const size_t ixCol = expected.getIxCol(ixCell);
+                    const TypedValue v = book.value(name, ixRow, ixCol);
+                    const TypedValue e = stdio.value(name, ixRow, ixCol);
+                    check(book.text(name, ixRow, ixCol) == stdio.text(name, ixRow, ixCol), where + ": text differs at row " + std::to_string(ixRow) + ", column " + std::to_string(ixCol));
+                    check(v.type == e.type && (v.num == e.num || (v.num != v.num && e.num != e.num)), where + ": value differs at row " + std::to_string(ixRow) + ", column " + std::to_string(ixCol));
+                }
+            }
+        }
+    }
+
+    // === members, inflated once ===
+    const std::string_view expectedMember = stdio.member(memberName);
+    for (size_t ixBook = 1; ixBook < 3; ++ixBook) {
+        const std::string_view m = books[ixBook]->member(memberName);
+        check(m == expectedMember, string(bookNames[ixBook]) + ": member '" + memberName + "' differs");
+        check(books[ixBook]->member(memberName).data() == m.data(), string(bookNames[ixBook]) + ": member '" + memberName + "' inflated twice");
+    }
+
+    if (nFailed > 0) return 1;
+    std::cout << fname << ": " << names.size() << " sheets agree (stdio, mmap, memory)" << endl;
+    return 0;
+}
@@ -0,0 +1,212 @@
+#ifndef CELL_VALUE_H
+#define CELL_VALUE_H
+
+// Typed cell values from the office:value-type attribute and its value attribute
+// (office:value, office:date-value, office:time-value, office:boolean-value), independent of the displayed text:p,
+// which is locale formatted ("1.234,50 €", "12%") and may be rounded.
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+enum valueType_e : uint8_t {
+    VT_STRING = 0,  // also: no or unknown office:value-type, or a value that failed to parse
+    VT_FLOAT,
+    VT_PERCENTAGE,  // as a fraction: 12% is 0.12
+    VT_CURRENCY,
+    VT_DATE,  // seconds since 1970-01-01T00:00:00, as written (no time zone)
+    VT_TIME,  // duration in seconds
+    VT_BOOLEAN  // 0 or 1
+};
+
+struct TypedValue {
+    valueType_e type = VT_STRING;
+    double num = 0;  // unused for VT_STRING
+};
+
+// === parsing ===
+
+// reads an unsigned decimal of exactly "nDigits" digits at s[ix]. Returns false if there is none.
+inline bool parseFixedDigits(std::string_view s, size_t ix, size_t nDigits, int& value) {
+    if (s.size() < ix + nDigits) return false;
+    value = 0;
+    for (size_t i = ix; i < ix + nDigits; ++i) {
+        if (s[i] < '0' || s[i] > '9') return false;
+        value = value * 10 + (s[i] - '0');
+    }
+    return true;
+}
+
+// days from 1970-01-01 to y-m-d in the proleptic Gregorian calendar
+inline int64_t daysFromCivil(int64_t y, int m, int d) {
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const int64_t yoe = y - era * 400;
+    const int64_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+// inverse of daysFromCivil()
+inline void civilFromDays(int64_t z, int64_t& y, int& m, int& d) {
+    z += 719468;
+    const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const int64_t doe = z - era * 146097;
+    const int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const int64_t mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = yoe + era * 400 + (m <= 2);
+}
+
+// office:date-value: "YYYY-MM-DD" or "YYYY-MM-DDThh:mm:ss[.fff]" to seconds since 1970-01-01
+inline bool parseDateValue(std::string_view s, double& seconds) {
+    int y, m, d;
+    if (s.size() < 10) return false;
+    if (!parseFixedDigits(s, 0, 4, y) || s[4] != '-' || !parseFixedDigits(s, 5, 2, m) || s[7] != '-' || !parseFixedDigits(s, 8, 2, d)) return false;
+    if (m < 1 || m > 12 || d < 1 || d > 31) return false;
+    seconds = daysFromCivil(y, m, d) * 86400.0;
+    if (s.size() == 10) return true;
+
+    int hh, mm, ss;
+    if (s.size() < 19 || s[10] != 'T' || !parseFixedDigits(s, 11, 2, hh) || s[13] != ':' || !parseFixedDigits(s, 14, 2, mm) || s[16] != ':' || !parseFixedDigits(s, 17, 2, ss)) return false;
+    seconds += hh * 3600.0 + mm * 60.0 + ss;
+    if (s.size() == 19) return true;
+    double frac;
+    if (s[19] != '.' || std::from_chars(s.data() + 19, s.data() + s.size(), frac).ptr != s.data() + s.size()) return false;
+    seconds += frac;
+    return true;
+}
+
+// office:time-value, an ISO 8601 duration such as "PT12H30M15S" or "-PT1H", to seconds
+inline bool parseTimeValue(std::string_view s, double& seconds) {
+    const bool negative = !s.empty() && s[0] == '-';
+    if (negative) s.remove_prefix(1);
+    if (s.size() < 2 || s[0] != 'P') return false;
+    s.remove_prefix(1);
+    seconds = 0;
+    bool inTime = false;
+    while (!s.empty()) {
+        if (s[0] == 'T') {
+            inTime = true;
+            s.remove_prefix(1);
+            continue;
+        }
+        double v;
+        const auto r = std::from_chars(s.data(), s.data() + s.size(), v);
+        if (r.ec != std::errc() || r.ptr == s.data() + s.size()) return false;
+        switch (*r.ptr) {
+            case 'D': seconds += v * 86400; break;
+            case 'H': seconds += v * 3600; break;
+            case 'M': seconds += inTime ? v * 60 : v * 30 * 86400; break;  // minutes, or (nominal) months
+            case 'S': seconds += v; break;
+            default: return false;
+        }
+        s.remove_prefix(r.ptr + 1 - s.data());
+    }
+    if (negative) seconds = -seconds;
+    return true;
+}
+
+inline valueType_e parseValueType(std::string_view s) {
+    if (s == "float") return VT_FLOAT;
+    if (s == "percentage") return VT_PERCENTAGE;
+    if (s == "currency") return VT_CURRENCY;
+    if (s == "date") return VT_DATE;
+    if (s == "time") return VT_TIME;
+    if (s == "boolean") return VT_BOOLEAN;
+    return VT_STRING;
+}
+
+// typed value from the attributes of a table:table-cell. Unknown types and malformed values give VT_STRING.
+inline TypedValue makeTypedValue(std::string_view valueType, std::string_view value, std::string_view dateValue, std::string_view timeValue, std::string_view booleanValue) {
+    TypedValue r;
+    r.type = parseValueType(valueType);
+    bool ok = false;
+    switch (r.type) {
+        case VT_FLOAT:
+        case VT_PERCENTAGE:
+        case VT_CURRENCY: {
+            const auto res = std::from_chars(value.data(), value.data() + value.size(), r.num);
+            ok = !value.empty() && res.ec == std::errc() && res.ptr == value.data() + value.size();
+            break;
+        }
+        case VT_DATE:
+            ok = parseDateValue(dateValue, r.num);
+            break;
+        case VT_TIME:
+            ok = parseTimeValue(timeValue, r.num);
+            break;
+        case VT_BOOLEAN:
+            ok = booleanValue == "true" || booleanValue == "false";
+            r.num = booleanValue == "true";
+            break;
+        case VT_STRING:
+            break;
+    }
+    if (!ok) r = TypedValue();
+    return r;
+}
+
+// === formatting ===
+
+// appends "us" microseconds as "hh:mm:ss" or "hh:mm:ss.ffffff" without trailing zeros. Hours may exceed 24.
+inline void appendClock(std::string& out, int64_t us) {
+    char buf[64];
+    const int64_t sec = us / 1000000;
+    snprintf(buf, sizeof(buf), "%02lld:%02d:%02d", (long long)(sec / 3600), (int)(sec / 60 % 60), (int)(sec % 60));
+    out += buf;
+    int frac = us % 1000000;
+    if (frac == 0) return;
+    int nDigits = 6;
+    for (; frac % 10 == 0; frac /= 10)
+        --nDigits;
+    snprintf(buf, sizeof(buf), ".%0*d", nDigits, frac);
+    out += buf;
+}
+
+// appends the value in a locale independent form: shortest round-trip number, ISO 8601 date "YYYY-MM-DD[Thh:mm:ss]",
+// time "hh:mm:ss" (hours may exceed 24), "true" / "false". Nothing for VT_STRING.
+inline void appendTypedValue(std::string& out, const TypedValue& v) {
+    char buf[64];
+    switch (v.type) {
+        case VT_FLOAT:
+        case VT_PERCENTAGE:
+        case VT_CURRENCY:
+            out.append(buf, std::to_chars(buf, buf + sizeof(buf), v.num).ptr);
+            break;
+        case VT_DATE: {
+            // === microseconds, split into day and time of day ===
+            const int64_t us = std::llround(v.num * 1e6);
+            const int64_t usPerDay = 86400LL * 1000000;
+            const int64_t days = us >= 0 ? us / usPerDay : -((-us + usPerDay - 1) / usPerDay);
+            int64_t y;
+            int m, d;
+            civilFromDays(days, y, m, d);
+            snprintf(buf, sizeof(buf), "%04lld-%02d-%02d", (long long)y, m, d);
+            out += buf;
+            if (us - days * usPerDay > 0) {
+                out += 'T';
+                appendClock(out, us - days * usPerDay);
+            }
+            break;
+        }
+        case VT_TIME: {
+            const int64_t us = std::llround(v.num * 1e6);
+            if (us < 0) out += '-';
+            appendClock(out, us < 0 ? -us : us);
+            break;
+        }
+        case VT_BOOLEAN:
+            out += v.num != 0 ? "true" : "false";
+            break;
+        case VT_STRING:
+            break;
+    }
+}
+
+#endif
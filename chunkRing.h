@@ -0,0 +1,93 @@
+#ifndef CHUNK_RING_H
+#define CHUNK_RING_H
+
+// Single-producer / single-consumer ring of fixed-size chunk buffers.
+// Used to overlap inflating (producer thread) with tokenizing (consumer thread): the producer fills free
+// chunks in order, the consumer processes filled chunks in the same order and hands them back.
+
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+class ChunkRing {
+   public:
+    ChunkRing(size_t nChunks, size_t chunkSize) : chunkSize(chunkSize), storage(nChunks * chunkSize), nFilled(nChunks, 0) {}
+
+    size_t getChunkSize() const { return chunkSize; }
+
+    // === producer side ===
+
+    // returns the next free chunk (chunkSize bytes), blocking while all chunks are in use. NULL if the consumer cancelled.
+    char* acquireFree() {
+        std::unique_lock<std::mutex> lock(m);
+        cvFree.wait(lock, [this] { return cancelled || nUsed < nFilled.size(); });
+        if (cancelled) return NULL;
+        return &storage[ixWrite * chunkSize];
+    }
+
+    // hands the chunk returned by acquireFree() to the consumer, with "n" valid bytes
+    void publish(size_t n) {
+        std::lock_guard<std::mutex> lock(m);
+        nFilled[ixWrite] = n;
+        ixWrite = (ixWrite + 1) % nFilled.size();
+        ++nUsed;
+        cvFilled.notify_one();
+    }
+
+    // no more chunks will follow. "ok" false signals a producer error to the consumer.
+    void close(bool ok) {
+        std::lock_guard<std::mutex> lock(m);
+        closed = true;
+        producerOk = ok;
+        cvFilled.notify_one();
+    }
+
+    // === consumer side ===
+
+    // waits for the next filled chunk. Returns false once the producer has closed the ring and all chunks are consumed.
+    bool acquireFilled(const char*& data, size_t& n) {
+        std::unique_lock<std::mutex> lock(m);
+        cvFilled.wait(lock, [this] { return closed || nUsed > 0; });
+        if (nUsed == 0) return false;
+        data = &storage[ixRead * chunkSize];
+        n = nFilled[ixRead];
+        return true;
+    }
+
+    // returns the chunk from acquireFilled() to the producer
+    void release() {
+        std::lock_guard<std::mutex> lock(m);
+        ixRead = (ixRead + 1) % nFilled.size();
+        --nUsed;
+        cvFree.notify_one();
+    }
+
+    // consumer gives up (e.g. parse error): unblocks and stops the producer
+    void cancel() {
+        std::lock_guard<std::mutex> lock(m);
+        cancelled = true;
+        cvFree.notify_one();
+    }
+
+    // valid after acquireFilled() returned false
+    bool isProducerOk() {
+        std::lock_guard<std::mutex> lock(m);
+        return producerOk;
+    }
+
+   protected:
+    const size_t chunkSize;
+    std::vector<char> storage;
+    std::vector<size_t> nFilled;  // valid bytes per chunk
+    size_t ixWrite = 0;
+    size_t ixRead = 0;
+    size_t nUsed = 0;  // chunks published but not yet released
+    bool closed = false;
+    bool producerOk = true;
+    bool cancelled = false;
+    std::mutex m;
+    std::condition_variable cvFree;
+    std::condition_variable cvFilled;
+};
+
+#endif
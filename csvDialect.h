@@ -0,0 +1,109 @@
+#ifndef CSV_DIALECT_H
+#define CSV_DIALECT_H
+
+// Output format settings and RFC 4180 field quoting.
+// Fields that contain the separator, the quote character, CR or LF are enclosed in quotes, embedded quotes are doubled.
+// The test for those characters takes 16 bytes per step with SSE2 where available, shorter text 8 or 4 bytes per step (SWAR).
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+struct CsvDialect {
+    enum quoting_e {
+        QUOTE_MINIMAL,  // only fields that need it
+        QUOTE_ALL,      // every non-empty field
+        QUOTE_NONE      // never, text is written as is
+    };
+    bool legacy = true;  // console format: no quoting, "\n" with a blank line between consecutive rows
+    char sepCol = ',';
+    char quote = '"';
+    std::string sepRow = "\n";
+    quoting_e quoting = QUOTE_MINIMAL;
+    bool values = false;  // write typed cell values (numbers, ISO dates, true / false) instead of the displayed text
+};
+
+// flags (high bit) the bytes of "v" that equal "c". There may be false flags, but only above a true one: exact as a yes/no test.
+inline uint64_t csvSwarMatch(uint64_t v, char c) {
+    const uint64_t x = v ^ (0x0101010101010101ull * (uint8_t)c);
+    return (x - 0x0101010101010101ull) & ~x & 0x8080808080808080ull;
+}
+
+// SWAR test of 8 bytes for "sepCol", "quote", CR or LF
+inline bool csvSwarAny(uint64_t v, char sepCol, char quote) {
+    return (csvSwarMatch(v, sepCol) | csvSwarMatch(v, quote) | csvSwarMatch(v, '\r') | csvSwarMatch(v, '\n')) != 0;
+}
+
+// returns true if "text" contains "sepCol", "quote", CR or LF.
+// Text that is not a multiple of the step size is covered by a last, overlapping step.
+inline bool csvNeedsQuotes(std::string_view text, char sepCol, char quote) {
+    const char* const p = text.data();
+    const size_t n = text.size();
+#ifdef __SSE2__
+    if (n >= 16) {
+        const __m128i vSep = _mm_set1_epi8(sepCol);
+        const __m128i vQuote = _mm_set1_epi8(quote);
+        const __m128i vCr = _mm_set1_epi8('\r');
+        const __m128i vLf = _mm_set1_epi8('\n');
+        auto any = [&](const char* at) {
+            const __m128i v = _mm_loadu_si128((const __m128i*)at);
+            const __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, vSep), _mm_cmpeq_epi8(v, vQuote)),
+                                             _mm_or_si128(_mm_cmpeq_epi8(v, vCr), _mm_cmpeq_epi8(v, vLf)));
+            return _mm_movemask_epi8(hit) != 0;
+        };
+        for (size_t ix = 0; ix + 16 <= n; ix += 16)
+            if (any(p + ix)) return true;
+        return any(p + n - 16);
+    }
+#endif
+    if (n >= 8) {
+        uint64_t v;
+        for (size_t ix = 0; ix + 8 <= n; ix += 8) {
+            memcpy(&v, p + ix, 8);
+            if (csvSwarAny(v, sepCol, quote)) return true;
+        }
+        memcpy(&v, p + n - 8, 8);
+        return csvSwarAny(v, sepCol, quote);
+    }
+    if (n >= 4) {
+        // === two overlapping 4 byte halves ===
+        uint32_t lo, hi;
+        memcpy(&lo, p, 4);
+        memcpy(&hi, p + n - 4, 4);
+        return csvSwarAny(lo | (uint64_t)hi << 32, sepCol, quote);
+    }
+    for (size_t ix = 0; ix < n; ++ix) {
+        const char c = p[ix];
+        if (c == sepCol || c == quote || c == '\r' || c == '\n') return true;
+    }
+    return false;
+}
+
+// appends "text" to "dest" as one field, quoted according to "dialect"
+inline void appendCsvField(std::string& dest, std::string_view text, const CsvDialect& dialect) {
+    if (dialect.legacy || dialect.quoting == CsvDialect::QUOTE_NONE || text.empty() ||
+        (dialect.quoting == CsvDialect::QUOTE_MINIMAL && !csvNeedsQuotes(text, dialect.sepCol, dialect.quote))) {
+        dest += text;
+        return;
+    }
+
+    // === quoted, with embedded quotes doubled ===
+    dest += dialect.quote;
+    while (true) {
+        const char* q = (const char*)memchr(text.data(), dialect.quote, text.size());
+        if (!q) break;
+        const size_t n = q - text.data() + 1;
+        dest.append(text.data(), n);
+        dest += dialect.quote;
+        text.remove_prefix(n);
+    }
+    dest += text;
+    dest += dialect.quote;
+}
+
+#endif
@@ -0,0 +1,147 @@
+#ifndef FLAT_BUILDER_H
+#define FLAT_BUILDER_H
+
+// Minimal FlatBuffers builder, enough for Arrow IPC metadata (tables, strings, vectors of structs and of tables).
+// Like the reference implementation, the buffer is built back to front: an object is written before the objects
+// referring to it, and references ("ref_t") count bytes from the end of the buffer. Scalars are written in host byte
+// order, which must be little endian.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "FlatBuffers are little endian");
+
+class FlatBuilder {
+   public:
+    typedef uint32_t ref_t;  // position of an object, as bytes from the end of the buffer
+
+    // === leaf objects ===
+
+    // zero terminated, length prefixed string
+    ref_t string(std::string_view s) {
+        align(s.size() + 1, 4);
+        prepend(1);  // terminator, zeroed
+        memcpy(prepend(s.size()), s.data(), s.size());
+        push<uint32_t>(s.size());
+        return used;
+    }
+
+    // vector of "n" structs of "size" bytes each at "p", aligned to "alignment"
+    ref_t structs(const void* p, size_t n, size_t size, size_t alignment) {
+        align(n * size, 4);
+        align(n * size, alignment);
+        uint8_t* dest = prepend(n * size);
+        if (n > 0) memcpy(dest, p, n * size);
+        push<uint32_t>(n);
+        return used;
+    }
+
+    // vector of references, e.g. to tables
+    ref_t refs(const std::vector<ref_t>& items) {
+        align(items.size() * 4, 4);
+        for (size_t ix = items.size(); ix-- > 0;)
+            pushRef(items[ix]);
+        push<uint32_t>(items.size());
+        return used;
+    }
+
+    // === tables: startTable(), add() / addRef() per field, endTable() ===
+
+    void startTable() {
+        fields.clear();
+        tableBegin = used;
+    }
+
+    // scalar field "id"
+    template <class T>
+    void add(uint16_t id, T value) {
+        push<T>(value);
+        fields.push_back({id, used});
+    }
+
+    // reference field "id" (string, vector, table), or the value of a union
+    void addRef(uint16_t id, ref_t ref) {
+        pushRef(ref);
+        fields.push_back({id, used});
+    }
+
+    ref_t endTable() {
+        // === table: offset to its vtable, then the fields ===
+        push<int32_t>(0);
+        const ref_t table = used;
+
+        // === vtable: its size, the table size, one field offset (from the table start, 0: absent) per id ===
+        uint16_t nIds = 0;
+        for (const field_t& f : fields)
+            nIds = std::max<uint16_t>(nIds, f.id + 1);
+        std::vector<uint16_t> vtable(2 + nIds, 0);
+        vtable[0] = vtable.size() * 2;
+        vtable[1] = table - tableBegin;
+        for (const field_t& f : fields)
+            vtable[2 + f.id] = table - f.pos;
+        for (size_t ix = vtable.size(); ix-- > 0;)
+            push<uint16_t>(vtable[ix]);
+
+        const int32_t toVtable = used - table;  // the vtable precedes the table
+        memcpy(at(table), &toVtable, 4);
+        return table;
+    }
+
+    // completes the buffer with "root" as its root table. The size is a multiple of 8.
+    std::string finish(ref_t root) {
+        align(4, 8);
+        pushRef(root);
+        return std::string((const char*)at(used), used);
+    }
+
+   protected:
+    struct field_t {
+        uint16_t id;
+        ref_t pos;
+    };
+
+    // address of the object at "ref"
+    uint8_t* at(ref_t ref) { return buf.data() + buf.size() - ref; }
+
+    // reserves "n" zeroed bytes in front of the buffer
+    uint8_t* prepend(size_t n) {
+        if (used + n > buf.size()) {
+            // === grow, keeping the content at the end ===
+            std::vector<uint8_t> grown(std::max(2 * buf.size(), used + n + 256), 0);
+            if (used > 0) memcpy(grown.data() + grown.size() - used, at(used), used);
+            buf.swap(grown);
+        }
+        used += n;
+        uint8_t* p = at(used);
+        if (n > 0) memset(p, 0, n);  // an empty builder has no storage yet: p may be null
+        return p;
+    }
+
+    // pads, so that "alignment" divides the position after writing "size" bytes
+    void align(size_t size, size_t alignment) {
+        prepend((alignment - (used + size) % alignment) % alignment);
+    }
+
+    template <class T>
+    void push(T value) {
+        align(sizeof(T), sizeof(T));
+        memcpy(prepend(sizeof(T)), &value, sizeof(T));
+    }
+
+    // offset from the written field forward to "ref"
+    void pushRef(ref_t ref) {
+        align(4, 4);
+        push<uint32_t>(used + 4 - ref);
+    }
+
+    std::vector<uint8_t> buf;
+    ref_t used = 0;  // bytes at the end of "buf" in use
+    ref_t tableBegin = 0;
+    std::vector<field_t> fields;  // of the table under construction
+};
+
+#endif
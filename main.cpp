@@ -1,52 +1,283 @@
 #include <cassert>
-#include <cstdlib>  // realloc
-#include <cstring>  // memcpy
+#include <algorithm>
+#include <cstdlib>  // malloc, realloc
+#include <fstream>
+#include <functional>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <vector>
 
+#include "arrowWriter.h"
+#include "chunkRing.h"
+#include "csvDialect.h"
+#include "minizip/iomem.h"
+#include "minizip/iommap.h"
 #include "minizip/unzip.h"
+#include "minizip/unzstream.h"
+#include "odsAtoms.h"
+#include "odsSax.h"
+#include "outSink.h"
+#include "sheet.h"
+#include "sheetFilter.h"
 #include "tinyxml2/tinyxml2.cpp"
+#include "workPool.h"
 
 using namespace tinyxml2;
-using std::runtime_error, std::string, std::cout, std::endl, std::map;
+using std::runtime_error, std::string, std::endl, std::map, std::vector;
 
-/* Loads "fileToExtract" from "zipfile". Returns buffer with contents or NULL, if failed.
-   Use free() on buffer to deallocate.
+// zip archive handle, closed on destruction
+typedef std::unique_ptr<void, int (*)(unzFile)> UnzHandle;
+
+/* Opens "zipfile". Returns a null handle if failed.
+   "mmapped" reads the archive via mmap() instead of stdio. "mapping" (optional) then receives the mapped file;
+   the pointed-to variable must outlive the handle.
+*/
+UnzHandle openArchive(const char* zipfile, bool mmapped, const mmap_file** mapping = NULL) {
+    if (!mmapped) return UnzHandle(unzOpen64(zipfile), unzClose);
+    zlib_filefunc64_def ffunc;
+    fill_mmap_filefunc64(&ffunc, mapping);
+    return UnzHandle(unzOpen2_64(zipfile, &ffunc), unzClose);
+}
+
+/* Opens the archive of "size" bytes at "data", which must outlive the handle, e.g. a member of an outer archive.
+   Returns a null handle if failed. "mapping" (optional) receives the view of "data", as with openArchive().
+*/
+UnzHandle openArchiveInMemory(const char* data, size_t size, const mmap_file** mapping = NULL) {
+    zlib_filefunc64_def ffunc;
+    fill_mem_filefunc64(&ffunc, mapping);
+    mem_source src = {data, size};
+    return UnzHandle(unzOpen2_64(&src, &ffunc), unzClose);
+}
+
+/* Makes "fileToExtract" the current member of "uf" and opens it for reading. Returns false if failed.
+   "info" receives the directory entry of the member.
+*/
+bool openCurrentMember(unzFile uf, const char* fileToExtract, unz_file_info64* info) {
+    if (unzLocateFile(uf, fileToExtract, /*case sensitive*/ 0) != UNZ_OK) return false;
+    if (unzGetCurrentFileInfo64(uf, info, NULL, 0, NULL, 0, NULL, 0) != UNZ_OK) return false;
+    return unzOpenCurrentFilePassword(uf, /*password*/ NULL) == UNZ_OK;
+}
+
+/* Opens "zipfile" and "fileToExtract" in it for reading. Returns a null handle if failed.
+   "info", "mmapped", "mapping": see openArchive() and openCurrentMember().
+*/
+UnzHandle openMember(const char* zipfile, const char* fileToExtract, bool mmapped, unz_file_info64* info, const mmap_file** mapping = NULL) {
+    UnzHandle uf = openArchive(zipfile, mmapped, mapping);
+    if (uf && !openCurrentMember(uf.get(), fileToExtract, info)) uf.reset();
+    return uf;
+}
+
+/* Inflates the current member of "uf" (opened by openCurrentMember(), with directory entry "info"). Returns buffer
+   with contents or NULL, if failed. Use free() on buffer to deallocate.
    length returns the number of bytes. Contents are null-terminated.
+   The buffer is allocated once, from the uncompressed size in the zip directory, and inflated into directly:
+   by a single inflate() call over the whole member (straight from "mapping", if the archive is mapped), or, where
+   the directory sizes are off, chunk by chunk.
 */
-char* unzipToBuf(const char* zipfile, const char* fileToExtract, int* length) {
-    unzFile uf = unzOpen64(zipfile);
-    if (!uf) return NULL;
-    if (unzLocateFile(uf, fileToExtract, /*case sensitive*/ 0) != UNZ_OK) return NULL;
-    if (unzOpenCurrentFilePassword(uf, /*password*/ NULL)) return NULL;
+char* inflateCurrentToBuf(unzFile uf, const unz_file_info64& info, const mmap_file* mapping, size_t* length) {
+    // === size from the directory, but don't trust a claim beyond deflate's maximum ratio (~1032:1) for the allocation ===
+    size_t capacity = info.uncompressed_size;
+    const ZPOS64_T maxPlausible = info.compressed_size * 1032 + 65536;
+    if (info.uncompressed_size > maxPlausible) capacity = maxPlausible;
+    char* retBuf = (char*)malloc(capacity + /*null termination*/ 1);
+    if (!retBuf) return NULL;
 
-    char chunk[65536];
-    int nRead = 0;
-    char* retBuf = NULL;
+    // === one shot. If the member does not qualify, or the directory understated its size, read it again in chunks ===
+    const ZPOS64_T pos = unzGetCurrentFileZStreamPos64(uf);
+    const bool inMapping = mapping && pos + info.compressed_size <= mapping->size;
+    ZPOS64_T nAll = 0;
+    const int err = unzReadCurrentFileAll(uf, inMapping ? mapping->base + pos : NULL, retBuf, capacity, &nAll);
+    if (err == UNZ_OK) {
+        retBuf[nAll] = 0;  // null termination
+        *length = nAll;
+        return retBuf;
+    }
+    if ((err != UNZ_PARAMERROR && err != UNZ_BADZIPFILE) ||
+        (err == UNZ_BADZIPFILE && unzOpenCurrentFilePassword(uf, /*password*/ NULL) != UNZ_OK)) {
+        free(retBuf);
+        return NULL;
+    }
+
+    size_t nRead = 0;
     while (1) {
-        int nBytes = unzReadCurrentFile(uf, chunk, sizeof(chunk));
-        if (nBytes < 0) {                        // error
-            retBuf = (char*)realloc(retBuf, 0);  // free
-            return NULL;
+        if (nRead == capacity) {
+            // === buffer is full: either the directory size was exact (=> EOF) or the archive understated it (=> grow) ===
+            char probe;
+            int nBytes = unzReadCurrentFile(uf, &probe, 1);
+            if (nBytes == 0) break;
+            char* grown = nBytes > 0 ? (char*)realloc(retBuf, 2 * capacity + 65536 + 1) : NULL;
+            if (!grown) {
+                free(retBuf);
+                return NULL;
+            }
+            retBuf = grown;
+            capacity = 2 * capacity + 65536;
+            retBuf[nRead++] = probe;
+            continue;
         }
 
+        // === inflate straight into the destination. unzReadCurrentFile takes an unsigned length and returns int ===
+        const size_t nMax = 1 << 30;
+        const size_t nWant = capacity - nRead < nMax ? capacity - nRead : nMax;
+        int nBytes = unzReadCurrentFile(uf, retBuf + nRead, nWant);
+        if (nBytes < 0) {  // error
+            free(retBuf);
+            return NULL;
+        }
         if (nBytes == 0)
             break;
-        retBuf = (char*)realloc(retBuf, nRead + nBytes + /*null termination*/ 1);
-        memcpy(/*dest*/ retBuf + nRead, /*src*/ chunk, nBytes);
-        *(retBuf + nRead + nBytes) = 0;  // null termination
         nRead += nBytes;
     }
+    retBuf[nRead] = 0;  // null termination
 
     *length = nRead;
     return retBuf;
 }
 
+/* Loads "fileToExtract" from "zipfile". Returns buffer with contents or NULL, if failed.
+   Use free() on buffer to deallocate. See inflateCurrentToBuf().
+*/
+char* unzipToBuf(const char* zipfile, const char* fileToExtract, bool mmapped, size_t* length) {
+    unz_file_info64 info;
+    const mmap_file* mapping = NULL;
+    UnzHandle uf = openMember(zipfile, fileToExtract, mmapped, &info, &mapping);
+    if (!uf) return NULL;
+    return inflateCurrentToBuf(uf.get(), info, mapping, length);
+}
+
+// receives inflated data. Returns false if it needs no more, which ends inflating early.
+typedef std::function<bool(const char* data, size_t n)> ChunkSink;
+
+// STORED (method 0) member of a memory-mapped archive: passes the member to "sink" in one piece, straight from the mapping.
+// As with inflated members, the CRC is checked after "sink" has seen the data, and not at all if it stopped early.
+bool sinkStoredInPlace(unzFile uf, const mmap_file* mapping, const unz_file_info64& info, const ChunkSink& sink) {
+    const ZPOS64_T pos = unzGetCurrentFileZStreamPos64(uf);
+    if (pos + info.compressed_size > mapping->size) return false;
+    const char* data = mapping->base + pos;
+    if (!sink(data, info.compressed_size)) return true;
+    return crc32_z(0, (const Bytef*)data, info.compressed_size) == info.crc;
+}
+
+/* Inflates "fileToExtract" from "zipfile" chunk by chunk and passes each chunk to "sink" as soon as it is available.
+   Returns false if the archive or member cannot be opened or is corrupt.
+   Stops early when "sink" returns false (the CRC of the part read is then not checked).
+   Exceptions thrown by "sink" propagate; the archive is closed in any case.
+   With "mmapped", a STORED member is passed to "sink" as a single chunk without any copy.
+*/
+bool unzipStreamed(const char* zipfile, const char* fileToExtract, bool mmapped, const ChunkSink& sink) {
+    unz_file_info64 info;
+    const mmap_file* mapping = NULL;
+    UnzHandle uf = openMember(zipfile, fileToExtract, mmapped, &info, &mapping);
+    if (!uf) return false;
+    if (mapping && info.compression_method == 0) return sinkStoredInPlace(uf.get(), mapping, info, sink);
+
+    char chunk[65536];
+    while (1) {
+        int nBytes = unzReadCurrentFile(uf.get(), chunk, sizeof(chunk));
+        if (nBytes < 0) return false;  // error
+        if (nBytes == 0) break;
+        if (!sink(chunk, nBytes)) return true;
+    }
+    return unzCloseCurrentFile(uf.get()) == UNZ_OK;  // checks CRC
+}
+
+/* Same as unzipStreamed() but inflates on a separate thread, ahead of "sink", through a ring of chunk buffers.
+   Decompression overlaps with whatever "sink" does with the previous chunks.
+*/
+bool unzipPipelined(const char* zipfile, const char* fileToExtract, bool mmapped, const ChunkSink& sink) {
+    unz_file_info64 info;
+    const mmap_file* mapping = NULL;
+    UnzHandle uf = openMember(zipfile, fileToExtract, mmapped, &info, &mapping);
+    if (!uf) return false;
+    if (mapping && info.compression_method == 0) return sinkStoredInPlace(uf.get(), mapping, info, sink);  // nothing to overlap
+
+    ChunkRing ring(/*nChunks*/ 8, /*chunkSize*/ 256 * 1024);
+    std::thread producer([&ring, &uf] {
+        while (char* chunk = ring.acquireFree()) {
+            int nBytes = unzReadCurrentFile(uf.get(), chunk, ring.getChunkSize());
+            if (nBytes <= 0) {
+                ring.close(/*ok*/ nBytes == 0 && unzCloseCurrentFile(uf.get()) == UNZ_OK);
+                return;
+            }
+            ring.publish(nBytes);
+        }
+    });
+
+    // === consume chunks in order. On exception, stop the producer before unwinding (it uses "ring" and "uf") ===
+    try {
+        const char* data;
+        size_t n;
+        while (ring.acquireFilled(data, n)) {
+            if (!sink(data, n)) {
+                // === enough: stop the producer ===
+                ring.cancel();
+                producer.join();
+                return true;
+            }
+            ring.release();
+        }
+    } catch (...) {
+        ring.cancel();
+        producer.join();
+        throw;
+    }
+    producer.join();
+    return ring.isProducerOk();
+}
+
+/* Same as unzipStreamed(), for an archive that can only be read front to back: "zipfile" is "-" for stdin, or e.g. a
+   named pipe. The local file headers are walked up to "fileToExtract" (minizip/unzstream.h), which is inflated as it
+   arrives, so "sink" sees the first chunk before the rest of the archive is received. "mmapped" does not apply.
+*/
+bool unzipForward(const char* zipfile, const char* fileToExtract, bool /*mmapped*/, const ChunkSink& sink) {
+    std::unique_ptr<void, int (*)(unzStream)> zs(unzsOpen(zipfile), unzsClose);
+    if (!zs || unzsLocateFile(zs.get(), fileToExtract, /*case sensitive*/ 0) != UNZ_OK) return false;
+
+    char chunk[65536];
+    while (1) {
+        int nBytes = unzsReadCurrentFile(zs.get(), chunk, sizeof(chunk));
+        if (nBytes < 0) return false;  // error
+        if (nBytes == 0) return true;  // CRC checked
+        if (!sink(chunk, nBytes)) return true;
+    }
+}
+
 //* traverse to next element of same type (name) e.g. table, row, cell in a spreadsheet */
 const XMLElement* xmlNext(const XMLElement* e) {
-    return e->NextSiblingElement(e->Value());
+    const int atom = e->Atom();
+    if (atom == ATOM_OTHER) return e->NextSiblingElement(e->Value());
+    do
+        e = e->NextSiblingElement();
+    while (e && e->Atom() != atom);
+    return e;
+}
+
+// first child element with atom "atom" (see odsAtoms.h), or NULL
+const XMLElement* firstChildElem(const XMLNode* n, odsAtom_e atom) {
+    const XMLElement* e = n->FirstChildElement();
+    while (e && e->Atom() != atom)
+        e = e->NextSiblingElement();
+    return e;
+}
+
+// typed value of a table:table-cell from office:value-type and the matching value attribute
+TypedValue cellValueOf(const XMLElement* cell) {
+    std::string_view attrs[5];  // office:value-type, office:value, office:date-value, office:time-value, office:boolean-value
+    for (const XMLAttribute* a = cell->FirstAttribute(); a; a = a->Next())
+        if (a->Atom() >= ATOM_OFFICE_VALUE_TYPE && a->Atom() <= ATOM_OFFICE_BOOLEAN_VALUE)
+            attrs[a->Atom() - ATOM_OFFICE_VALUE_TYPE] = a->Value();
+    return makeTypedValue(attrs[0], attrs[1], attrs[2], attrs[3], attrs[4]);
+}
+
+// value of the attribute with atom "atom" (see odsAtoms.h), or NULL
+const char* attributeOf(const XMLElement* e, odsAtom_e atom) {
+    for (const XMLAttribute* a = e->FirstAttribute(); a; a = a->Next())
+        if (a->Atom() == atom) return a->Value();
+    return NULL;
 }
 
 // converts text:p to a plain string, regardless of formatting (=> handles XML text children and text:span children with an XML text child)
@@ -56,13 +287,15 @@ string stringifyTextPElem(const XMLNode* n) {
     n = n->FirstChild();
     string r;
     while (n) {
-        const string v = n->Value();
-        if (n->ToText())  // is this a text node?
-            r = r + v;    // if so, Value() is the actual text
-        else if (v == "text:span")
-            if (n->FirstChild())
-                if (n->FirstChild()->ToText() && n->FirstChild()->Value())
-                    r = r + n->FirstChild()->Value();
+        if (n->ToText()) {  // is this a text node?
+            r += n->Value();  // if so, Value() is the actual text
+        } else {
+            const XMLElement* e = n->ToElement();
+            if (e && e->Atom() == ATOM_TEXT_SPAN)
+                if (n->FirstChild())
+                    if (n->FirstChild()->ToText() && n->FirstChild()->Value())
+                        r += n->FirstChild()->Value();
+        }
         n = n->NextSibling();
     }
     return r;
@@ -74,80 +307,104 @@ const XMLNode* safeFirstChildElem(const XMLNode* e, const char* targetElem) {
     return e;
 }
 
-// returns table row indexed by column number
-map<size_t, string> parseRow(const XMLElement* row) {
+// adds the non-empty cells of a table row in columns [range.colBegin, range.colEnd) to "sheet" as runs of repeated cells.
+// Columns are relative to range.colBegin; cells outside are not stringified.
+void parseRow(const XMLElement* row, Sheet& sheet, const CellRange& range) {
     assert(row);
     assert(row->Value() == string("table:table-row"));
 
-    map<size_t, string> r;
     // === locate first cell in XML hierarchy ===
-    const XMLElement* cell = row->FirstChildElement("table:table-cell");
+    const XMLElement* cell = firstChildElem(row, ATOM_TABLE_TABLE_CELL);
     size_t ixCol = 0;
     while (cell) {
         size_t nColRep = 1;
-        const char* tnColRep = cell->Attribute("table:number-columns-repeated");
+        const char* tnColRep = attributeOf(cell, ATOM_TABLE_NUMBER_COLUMNS_REPEATED);
         if (tnColRep != NULL)
             nColRep = std::atol(tnColRep);
-        //        nColRep = nColRep < 1000 ? nColRep : 1;  // heuristic hack to fix format error
+        if (ixCol >= range.colEnd) break;
+        const size_t nInRange = overlap(ixCol, nColRep, range.colBegin, range.colEnd);
 
         // === extract value ===
-        const XMLElement* text = cell->FirstChildElement("text:p");
-        const string textContent = text ? stringifyTextPElem(text) : "";
-        if (textContent.size() > 0) {
-            for (size_t ix = 0; ix < nColRep; ++ix) {
-                auto v = r.insert({ixCol++, textContent});
-                assert(/*insertion succeeded */ v.second);
+        if (nInRange > 0) {
+            // === one text:p per line of the cell ===
+            string textContent;
+            const XMLElement* text = firstChildElem(cell, ATOM_TEXT_P);
+            while (text) {
+                textContent += stringifyTextPElem(text);
+                text = xmlNext(text);
+                if (text) textContent += '\n';
             }
-        } else {
-            ixCol += nColRep;
+            if (textContent.size() > 0)
+                sheet.addCell(std::max(ixCol, range.colBegin) - range.colBegin, nInRange, textContent, cellValueOf(cell));
         }
+        ixCol += nColRep;
         cell = xmlNext(cell);
     }  // while cell
-    return r;
 }
 
-// returns map hierarchy for one table indexed by row number then column number
-map<size_t, map<size_t, string>> parseTable(const XMLElement* e) {
+// returns the non-empty rows of one table as runs of repeated rows. Cell texts are interned in "pool".
+// Only cells in "range" are parsed, with positions relative to its top left cell.
+Sheet parseTable(const XMLElement* e, const std::shared_ptr<StringPool>& pool, const CellRange& range) {
     assert(e);
     assert(e->Value() == string("table:table"));
 
-    map<size_t, map<size_t, string>> r;
+    Sheet r(pool);
     // === locate first row in XML hierarchy ===
-    const XMLElement* row = e->FirstChildElement("table:table-row");
+    const XMLElement* row = firstChildElem(e, ATOM_TABLE_TABLE_ROW);
     size_t ixRow = 0;
     while (row) {
-        string rowOut;
         size_t nRowRep = 1;
-        const char* tnRowRep = row->Attribute("table:number-rows-repeated");
+        const char* tnRowRep = attributeOf(row, ATOM_TABLE_NUMBER_ROWS_REPEATED);
         if (tnRowRep != NULL)
             nRowRep = std::atol(tnRowRep);
-        //        nRowRep = nRowRep < 1000 ? nRowRep : 1;  // heuristic hack to fix format error
+        if (ixRow >= range.rowEnd) break;
+        const size_t nInRange = overlap(ixRow, nRowRep, range.rowBegin, range.rowEnd);
 
-        map<size_t, string> rowMap = parseRow(row);
-        if (rowMap.size() > 0) {
-            for (size_t ixRowRep = 0; ixRowRep < nRowRep; ++ixRowRep) {
-                auto v = r.insert({ixRow++, rowMap});
-                assert(/*insertion succeeded*/ v.second);
-            }
-        } else {
-            ixRow += nRowRep;
+        if (nInRange > 0) {
+            r.beginRow(std::max(ixRow, range.rowBegin) - range.rowBegin, nInRange);
+            parseRow(row, r, range);
+            r.endRow();
         }
+        ixRow += nRowRep;
         row = xmlNext(row);
     }  // while row
     return r;
 }
 
-// returns map hierarchy indexed by sheet name/row number/column number
-map<string, map<size_t, map<size_t, string>>> ods2txt_sparse(const string& fname) {
-    // === load XML from .ods (which is a zip file internally) ===
-    int lengthOfXmlData;
-    char* buf = unzipToBuf(fname.c_str(), "content.xml", &lengthOfXmlData);
-    if (!buf) throw runtime_error(string("unzip failed for '") + fname + "'");
+// DOM parse of the tables in "xml" that "filter" selects, skipping the others unparsed
+map<string, Sheet> parseSelectedTables(std::unique_ptr<char, void (*)(void*)> xml, size_t lengthOfXmlData, const SheetFilter& filter) {
+    const vector<std::pair<size_t, size_t>> spans = findTableSpans(xml.get(), xml.get() + lengthOfXmlData);
+    if (spans.empty()) throw runtime_error("document contains no tables!");
+
+    map<string, Sheet> r;
+    const auto pool = std::make_shared<StringPool>();
+    for (size_t ixSpan = 0; ixSpan < spans.size(); ++ixSpan) {
+        const char* spanBegin = xml.get() + spans[ixSpan].first;
+        const char* spanEnd = xml.get() + spans[ixSpan].second;
+        const char* tagEnd;
+        const string name = tableSpanName(spanBegin, spanEnd, tagEnd);
+        if (!filter.selects(name, ixSpan)) continue;
+
+        // === the table:table element is the root of a document of its own ===
+        XMLDocument doc;
+        doc.SetAtomizer(odsAtom);
+        if (XML_SUCCESS != doc.Parse(spanBegin, spanEnd - spanBegin)) throw runtime_error("XML parse failed for table '" + name + "' in content.xml");
+        r.insert({name, parseTable(doc.FirstChildElement(), pool, filter.range)});
+    }
+    if (r.empty()) throw runtime_error("no table matches the sheet selection");
+    return r;
+}
+
+// returns table data indexed by sheet name, from content.xml in "buf" ("lengthOfXmlData" bytes, taken over).
+// With a selection in "filter", the table:table elements are located by a byte scan and only the selected ones are parsed, each on its own.
+// "fname" names the workbook in error messages.
+map<string, Sheet> parseContentXml(char* buf, size_t lengthOfXmlData, const SheetFilter& filter, const string& fname) {
+    if (!filter.all()) return parseSelectedTables(std::unique_ptr<char, void (*)(void*)>(buf, free), lengthOfXmlData, filter);
 
-    // === load XML ===
+    // === load XML. The document takes over "buf" and parses it in place (no copy) ===
     XMLDocument doc;
-    if (XML_SUCCESS != doc.Parse(buf, lengthOfXmlData)) throw runtime_error(string("XML parse failed for content.xml in '") + fname);
-    free(buf);
+    doc.SetAtomizer(odsAtom);  // known element and attribute names are matched by atom
+    if (XML_SUCCESS != doc.ParseAdopt(buf, lengthOfXmlData)) throw runtime_error(string("XML parse failed for content.xml in '") + fname);
 
     // === locate first spreadsheet in XML hierarchy ===
     const XMLNode* e = &doc;
@@ -157,68 +414,711 @@ map<string, map<size_t, map<size_t, string>>> ods2txt_sparse(const string& fname
     const XMLElement* table = safeFirstChildElem(e, "table:table")->ToElement();
     if (!table) throw runtime_error("document contains no tables!");
 
-    map<string, map<size_t, map<size_t, string>>> r;
+    map<string, Sheet> r;
+    const auto pool = std::make_shared<StringPool>();  // shared by all sheets of the workbook
 
     while (table) {
-        const char* tname = table->Attribute("table:name");
+        const char* tname = attributeOf(table, ATOM_TABLE_NAME);
         if (!tname) throw runtime_error("no table name");
-        const auto& v = r.insert({tname, parseTable(table)});
+        const auto& v = r.insert({tname, parseTable(table, pool, filter.range)});
         assert(/*insertion succeeded*/ v.second);
         table = xmlNext(table);
     }  // while table
     return r;
 }
 
-int main(int argc, const char** argv) {
-    const string sepCol(",");
-    const string sepRow("\n");
+// returns table data indexed by sheet name. "mmapped": read the archive via mmap()
+map<string, Sheet> ods2txt_sparse(const string& fname, bool mmapped, const SheetFilter& filter = SheetFilter()) {
+    // === load XML from .ods (which is a zip file internally) ===
+    size_t lengthOfXmlData;
+    char* buf = unzipToBuf(fname.c_str(), "content.xml", mmapped, &lengthOfXmlData);
+    if (!buf) throw runtime_error(string("unzip failed for '") + fname + "'");
+    return parseContentXml(buf, lengthOfXmlData, filter, fname);
+}
 
-    if (argc < 1) throw runtime_error("??? cmd line args: executable location is missing ???");
-    if (argc < 2) throw runtime_error("need one argument 'inputfile.ods' (openOffice spreadsheet)");
-    const char* fname = argv[1];
+// Same as ods2txt_sparse() for the workbook of "size" bytes at "data", e.g. a member of an outer archive or a message
+// payload. No file is involved: content.xml is inflated straight from "data".
+map<string, Sheet> ods2txt_buffer(const char* data, size_t size, const SheetFilter& filter = SheetFilter()) {
+    unz_file_info64 info;
+    const mmap_file* mapping = NULL;
+    UnzHandle uf = openArchiveInMemory(data, size, &mapping);
+    size_t lengthOfXmlData;
+    char* buf = uf && openCurrentMember(uf.get(), "content.xml", &info) ? inflateCurrentToBuf(uf.get(), info, mapping, &lengthOfXmlData) : NULL;
+    if (!buf) throw runtime_error("unzip failed for the workbook in memory");
+    return parseContentXml(buf, lengthOfXmlData, filter, "(in memory)");
+}
+
+/* An open workbook, for a long-lived process that queries it many times (list sheets, read ranges, read typed cells).
+   Owns the archive handle, which stays open, the members inflated so far and the sheets parsed so far, all shared by
+   the queries: content.xml is inflated and scanned for its tables on first use, each sheet is parsed when first
+   asked for. Later queries neither reopen the archive nor inflate or parse again.
+   Not thread safe. Not copyable: a memory-mapped or in-memory archive refers to the workbook's "mapping".
+*/
+class Workbook {
+   public:
+    // opens "fname", via mmap() with "mmapped"
+    explicit Workbook(const string& fname, bool mmapped = false) : fname(fname), uf(openArchive(fname.c_str(), mmapped, &mapping)) {
+        if (!uf) throw runtime_error("cannot open '" + fname + "' as a zip archive");
+    }
+
+    // opens the workbook of "size" bytes at "data", which must outlive the workbook
+    static Workbook fromMemory(const void* data, size_t size) { return Workbook(InMemory(), data, size); }
+    Workbook(const Workbook&) = delete;
+    Workbook& operator=(const Workbook&) = delete;
+
+    // names of the sheets, in document order
+    const vector<string>& sheetNames() {
+        scanTables();
+        return names;
+    }
+
+    // all cells of sheet "name"
+    const Sheet& sheet(const string& name) {
+        scanTables();
+        const size_t ixTable = std::find(names.begin(), names.end(), name) - names.begin();
+        if (ixTable == names.size()) throw runtime_error("no sheet '" + name + "' in '" + fname + "'");
+        std::unique_ptr<Sheet>& parsed = sheets[ixTable];
+        if (!parsed) {
+            // === the table:table element is the root of a document of its own ===
+            const std::string_view xml = member("content.xml");
+            XMLDocument doc;
+            doc.SetAtomizer(odsAtom);
+            if (XML_SUCCESS != doc.Parse(xml.data() + spans[ixTable].first, spans[ixTable].second - spans[ixTable].first))
+                throw runtime_error("XML parse failed for table '" + name + "' in content.xml");
+            parsed = std::make_unique<Sheet>(parseTable(doc.FirstChildElement(), pool, CellRange()));
+        }
+        return *parsed;
+    }
+
+    // cells of "range" of sheet "name", with its top left cell at row 0, column 0
+    Sheet range(const string& name, const CellRange& range) {
+        const Sheet& full = sheet(name);
+        Sheet r(pool);
+        for (size_t ixRun = 0; ixRun < full.nRowRuns() && full.getIxRow(ixRun) < range.rowEnd; ++ixRun) {
+            const size_t ixRow = full.getIxRow(ixRun);
+            const size_t nInRange = overlap(ixRow, full.getNRowRep(ixRun), range.rowBegin, range.rowEnd);
+            if (nInRange == 0) continue;
+            r.beginRow(std::max(ixRow, range.rowBegin) - range.rowBegin, nInRange);
+            for (size_t ixCell = full.cellBegin(ixRun); ixCell < full.cellEnd(ixRun); ++ixCell) {
+                const size_t ixCol = full.getIxCol(ixCell);
+                const size_t nColsInRange = overlap(ixCol, full.getNColRep(ixCell), range.colBegin, range.colEnd);
+                if (nColsInRange > 0)
+                    r.addCell(std::max(ixCol, range.colBegin) - range.colBegin, nColsInRange, full.getText(ixCell), full.getValue(ixCell));
+            }
+            r.endRow();
+        }
+        return r;
+    }
+
+    // displayed text of the cell at "ixRow", "ixCol" (from 0) of sheet "name", empty if the cell is empty
+    std::string_view text(const string& name, size_t ixRow, size_t ixCol) { return sheet(name).at(ixRow, ixCol); }
+
+    // typed value of the cell at "ixRow", "ixCol" (from 0) of sheet "name", VT_STRING if the cell is empty
+    TypedValue value(const string& name, size_t ixRow, size_t ixCol) { return sheet(name).valueAt(ixRow, ixCol); }
+
+    // contents of member "name" of the archive, e.g. "styles.xml", inflated on first use. Null-terminated.
+    std::string_view member(const string& name) {
+        auto it = members.find(name);
+        if (it == members.end()) {
+            unz_file_info64 info;
+            size_t length = 0;
+            char* buf = openCurrentMember(uf.get(), name.c_str(), &info) ? inflateCurrentToBuf(uf.get(), info, mapping, &length) : NULL;
+            std::unique_ptr<char, void (*)(void*)> data(buf, free);
+            if (!data || unzCloseCurrentFile(uf.get()) != UNZ_OK)  // checks CRC
+                throw runtime_error("unzip failed for " + name + " in '" + fname + "'");
+            it = members.emplace(name, std::make_pair(std::move(data), length)).first;
+        }
+        return std::string_view(it->second.first.get(), it->second.second);
+    }
+
+   protected:
+    // selects the in-memory constructor, which a (path, flag) call could otherwise reach by accident
+    struct InMemory {};
+    Workbook(InMemory, const void* data, size_t size) : fname("(in memory)"), uf(openArchiveInMemory((const char*)data, size, &mapping)) {
+        if (!uf) throw runtime_error("cannot open the workbook in memory as a zip archive");
+    }
+
+    // inflates content.xml and locates its tables, once
+    void scanTables() {
+        if (!names.empty()) return;
+        const std::string_view xml = member("content.xml");
+        vector<std::pair<size_t, size_t>> found = findTableSpans(xml.data(), xml.data() + xml.size());
+        if (found.empty()) throw runtime_error("document contains no tables!");
+        for (const auto& span : found) {
+            const char* tagEnd;
+            names.push_back(tableSpanName(xml.data() + span.first, xml.data() + span.second, tagEnd));
+        }
+        spans.swap(found);
+        sheets.resize(names.size());
+    }
+
+    const string fname;
+    const mmap_file* mapping = NULL;  // set by the archive handle if mapped, so declared before it
+    UnzHandle uf;
+    map<string, std::pair<std::unique_ptr<char, void (*)(void*)>, size_t>> members;  // inflated, with their lengths
+    vector<string> names;                     // of the tables in content.xml, document order
+    vector<std::pair<size_t, size_t>> spans;  // of the tables in content.xml
+    vector<std::unique_ptr<Sheet>> sheets;    // parsed on first use, per table
+    std::shared_ptr<StringPool> pool = std::make_shared<StringPool>();  // shared by all sheets of the workbook
+};
+
+// writes sheets as "$NEW_SHEET,name", one line per row with separated cells, "$END_SHEET".
+// Fields are quoted according to "dialect"; the legacy console format writes them unquoted.
+class SheetWriter {
+   public:
+    SheetWriter(OutSink& out, const CsvDialect& dialect) : out(out), dialect(dialect) {}
+
+    void beginSheet(const string& tableName) {
+        line.assign("$NEW_SHEET");
+        line += dialect.sepCol;
+        appendCsvField(line, tableName, dialect);
+        out.put(line);
+        out.put(dialect.sepRow);
+        nextIxRow = 0;
+    }
+
+    // writes row run "ixRun" of "sheet" (nRep copies of a row). The row is formatted once, then repeated.
+    void rows(const Sheet& sheet, size_t ixRun) {
+        const size_t ixRow = sheet.getIxRow(ixRun);
+        const size_t nRep = sheet.getNRowRep(ixRun);
+
+        // === format row ===
+        line.clear();
+        size_t lastTerminatedIxCol = 0;
+        for (size_t ixCell = sheet.cellBegin(ixRun); ixCell < sheet.cellEnd(ixRun); ++ixCell) {
+            // === write column separators ===
+            const size_t ixCol = sheet.getIxCol(ixCell);
+            line.append(ixCol - lastTerminatedIxCol, dialect.sepCol);
+
+            // === write cell content. Repeated cells are formatted once ===
+            const size_t nColRep = sheet.getNColRep(ixCell);
+            if (nColRep == 1) {
+                appendCell(line, sheet, ixCell);
+            } else {
+                field.clear();
+                appendCell(field, sheet, ixCell);
+                line += field;
+                for (size_t ixRep = 1; ixRep < nColRep; ++ixRep) {
+                    line += dialect.sepCol;
+                    line += field;
+                }
+            }
+            lastTerminatedIxCol = ixCol + nColRep - 1;
+        }
+        if (line.empty()) return;  // defer output of possibly trailing separators
+
+        // === write row separators and row ===
+        for (size_t ixRep = 0; ixRep < nRep; ++ixRep) {
+            out.repeat(dialect.sepRow, ixRow + ixRep - nextIxRow);
+            out.put(line);
+            out.put(dialect.sepRow);
+            nextIxRow = ixRow + ixRep + (dialect.legacy ? 0 : 1);
+        }
+    }
+
+    void endSheet() {
+        out.put("$END_SHEET");
+        out.put(dialect.sepRow);
+    }
+
+   protected:
+    // appends cell "ixCell" as one field: its displayed text or, with "dialect.values", its typed value if it has one
+    void appendCell(string& dest, const Sheet& sheet, size_t ixCell) {
+        const TypedValue value = sheet.getValue(ixCell);
+        if (!dialect.values || value.type == VT_STRING) {
+            appendCsvField(dest, sheet.getText(ixCell), dialect);
+            return;
+        }
+        valueText.clear();
+        appendTypedValue(valueText, value);
+        appendCsvField(dest, valueText, dialect);
+    }
+
+    OutSink& out;
+    const CsvDialect dialect;
+    size_t nextIxRow = 0;  // row index of the next line. The legacy format lags by one, writing a blank line between consecutive rows.
+    string line;           // formatted row, reused
+    string field;          // formatted cell, reused
+    string valueText;      // typed value as text, reused
+};
+
+// collects SAX cell events into the rows of a Sheet (runs of repeated cells) and reports each completed, non-empty row
+class RowAssembler : public OdsSaxHandler {
+   public:
+    void tableStart(const string& name) override {
+        ixRow = 0;
+        sheetStart(name);
+    }
+    void tableEnd() override {
+        sheetEnd();
+    }
+    void rowStart(size_t nRowRep) override {
+        sheet.beginRow(ixRow, nRowRep);
+        this->nRowRep = nRowRep;
+        ixCol = 0;
+    }
+    void rowEnd() override {
+        const size_t nRuns = sheet.nRowRuns();
+        sheet.endRow();
+        if (sheet.nRowRuns() > nRuns) rowDone(nRuns);
+        ixRow += nRowRep;
+    }
+    void cell(const string& text, const TypedValue& value, size_t nColRep) override {
+        if (text.size() > 0 && nColRep > 0)
+            sheet.addCell(ixCol, nColRep, text, value);
+        ixCol += nColRep;
+    }
+
+   protected:
+    virtual void sheetStart(const string& name) = 0;
+    virtual void sheetEnd() = 0;
+    // row run "ixRun" of "sheet" was just completed
+    virtual void rowDone(size_t ixRun) = 0;
+
+    Sheet sheet;
+    size_t nRowRep = 1;
+    size_t ixRow = 0;
+    size_t ixCol = 0;
+
+   public:
+    // rows seen so far in the current table, including repeated and empty ones
+    size_t getNRows() const { return ixRow; }
+};
+
+// writes each row as soon as it is complete. Sheets appear in document order.
+// Repeated rows and cells stay run-length encoded until the writer expands them.
+class StreamingSheetWriter : public RowAssembler {
+   public:
+    StreamingSheetWriter(SheetWriter& w) : w(w) {}
+
+   protected:
+    void sheetStart(const string& name) override {
+        w.beginSheet(name);
+    }
+    void sheetEnd() override {
+        w.endSheet();
+    }
+    void rowDone(size_t ixRun) override {
+        w.rows(sheet, ixRun);
+        // === hold one row at a time ===
+        sheet.clear();
+        sheet.getPool().clear();
+    }
+
+    SheetWriter& w;
+};
+
+// builds the in-memory Sheet of the parsed table(s)
+class TableBuilder : public RowAssembler {
+   public:
+    string name;  // of the last table
+    Sheet& getSheet() { return sheet; }
+
+   protected:
+    void sheetStart(const string& name) override {
+        this->name = name;
+        sheet.clear();
+    }
+    void sheetEnd() override {}
+    void rowDone(size_t /*ixRun*/) override {}
+};
+
+// hands each table to "emit" once it is complete, for output formats that need a whole sheet. Holds one table at a time.
+class SheetCollector : public RowAssembler {
+   public:
+    SheetCollector(const std::function<void(const string& name, const Sheet& table)>& emit) : emit(emit) {}
+
+   protected:
+    void sheetStart(const string& name) override {
+        this->name = name;
+        sheet.clear();
+        sheet.getPool().clear();
+    }
+    void sheetEnd() override {
+        emit(name, sheet);
+    }
+    void rowDone(size_t /*ixRun*/) override {}
+
+    std::function<void(const string& name, const Sheet& table)> emit;
+    string name;
+};
+
+// streaming counterpart of ods2txt_sparse(): content.xml is inflated and tokenized chunk by chunk, "handler" sees each row as soon as it is complete.
+// "pipelined" inflates on a second thread concurrently with tokenizing. "mmapped": read the archive via mmap()
+// Tables not selected by "filter" are skipped without tokenizing, cells outside its range are not reported.
+// Inflating stops once the last selected table is complete (or its range is passed).
+void ods2txt_stream(const string& fname, OdsSaxHandler& handler, bool pipelined, bool mmapped, const SheetFilter& filter = SheetFilter()) {
+    OdsSaxParser parser(handler, OdsSaxParser::DOCUMENT, filter);
+    auto unzipFun = fname == "-" ? unzipForward : pipelined ? unzipPipelined : unzipStreamed;
+    auto feed = [&](const char* data, size_t n) {
+        parser.feed(data, n);
+        return !parser.isDone();  // stop inflating once the selected tables are complete
+    };
+    if (!unzipFun(fname.c_str(), "content.xml", mmapped, feed))
+        throw runtime_error(string("unzip failed for '") + fname + "'");
+    parser.finish();
+}
+
+/* Parallel variant of ods2txt_sparse(): inflates content.xml completely, locates the table:table elements with a fast scan
+   and parses them concurrently on "nWorkers" threads.
+   With "splitRows", each table body is additionally cut into pieces at table:table-row boundaries, which are parsed
+   concurrently as well. Row indices of a piece are offset by the row count (including number-rows-repeated) of the pieces before it.
+   "emit" receives the sheets in document order, each as soon as it and all sheets before it are parsed.
+   Only tables selected by "filter" are parsed, and only the cells in its range. A row range turns "splitRows" off:
+   the rows of a piece can only be numbered once the pieces before it are parsed.
+*/
+void ods2txt_parallel(const string& fname, bool mmapped, size_t nWorkers, bool splitRows, const std::function<void(const string& name, const Sheet& table)>& emit, const SheetFilter& filter = SheetFilter()) {
+    size_t lengthOfXmlData;
+    std::unique_ptr<char, void (*)(void*)> buf(unzipToBuf(fname.c_str(), "content.xml", mmapped, &lengthOfXmlData), free);
+    if (!buf) throw runtime_error(string("unzip failed for '") + fname + "'");
+    if (filter.range.hasRows()) splitRows = false;
+
+    vector<std::pair<size_t, size_t>> spans = findTableSpans(buf.get(), buf.get() + lengthOfXmlData);
+    if (spans.empty()) throw runtime_error("document contains no tables!");
+    if (!filter.all()) {
+        // === drop the tables that are not selected ===
+        size_t nKept = 0;
+        for (size_t ixSpan = 0; ixSpan < spans.size(); ++ixSpan) {
+            const char* tagEnd;
+            if (filter.selects(tableSpanName(buf.get() + spans[ixSpan].first, buf.get() + spans[ixSpan].second, tagEnd), ixSpan))
+                spans[nKept++] = spans[ixSpan];
+        }
+        spans.resize(nKept);
+        if (spans.empty()) throw runtime_error("no table matches the sheet selection");
+    }
+
+    // === one task per table, or per piece of a table ===
+    struct Task {
+        size_t ixSpan;
+        size_t begin;  // in "buf"
+        size_t end;
+        bool isLastOfTable;
+    };
+    vector<Task> tasks;
+    vector<string> names(spans.size());
+    for (size_t ixSpan = 0; ixSpan < spans.size(); ++ixSpan) {
+        const size_t spanBegin = spans[ixSpan].first;
+        if (!splitRows) {
+            tasks.push_back({ixSpan, spanBegin, spans[ixSpan].second, true});
+            continue;
+        }
+        TableSplit split = splitTableSpan(buf.get() + spanBegin, buf.get() + spans[ixSpan].second, 4 * nWorkers, /*minPieceSize*/ 1 << 18);
+        names[ixSpan] = split.name;
+        for (const auto& piece : split.pieces)
+            tasks.push_back({ixSpan, spanBegin + piece.first, spanBegin + piece.second, false});
+        if (split.pieces.empty())
+            tasks.push_back({ixSpan, 0, 0, false});
+        tasks.back().isLastOfTable = true;
+    }
+
+    SheetFilter rangeOnly;  // tables are selected above
+    rangeOnly.range = filter.range;
+    vector<TableBuilder> results(tasks.size());
+    Sheet table;           // table being assembled from pieces
+    size_t rowOffset = 0;  // rows in the pieces of "table" so far
+    runOrdered(
+        tasks.size(), nWorkers,
+        /*work*/ [&](size_t ix) {
+            const Task& t = tasks[ix];
+            OdsSaxParser parser(results[ix], splitRows ? OdsSaxParser::TABLE : OdsSaxParser::SPREADSHEET, rangeOnly);
+            parser.feed(buf.get() + t.begin, t.end - t.begin);
+            parser.finish();
+        },
+        /*emit*/ [&](size_t ix) {
+            const Task& t = tasks[ix];
+            if (!splitRows) {
+                emit(results[ix].name, results[ix].getSheet());
+                results[ix].getSheet() = Sheet();  // release memory
+                return;
+            }
+            table.append(results[ix].getSheet(), rowOffset);
+            rowOffset += results[ix].getNRows();
+            results[ix].getSheet() = Sheet();
+            if (t.isLastOfTable) {
+                emit(names[t.ixSpan], table);
+                table.clear();
+                rowOffset = 0;
+            }
+        });
+}
+
+void writeTable(SheetWriter& writer, const string& name, const Sheet& table) {
+    writer.beginSheet(name);
+    for (size_t ixRun = 0; ixRun < table.nRowRuns(); ++ixRun)
+        writer.rows(table, ixRun);
+    writer.endSheet();
+}
+
+// command line settings
+struct Options {
+    bool stream = false;     // event-driven parse, memory bounded by one row
+    bool pipelined = false;  // stream, with inflate on a separate thread
+    bool mmapped = false;    // archive access via mmap() instead of stdio
+    bool parallelSheets = false;  // parse the sheets of one workbook concurrently
+    bool parallelRows = false;    // also split each sheet at row boundaries
+    size_t nWorkers = std::thread::hardware_concurrency();
+    CsvDialect dialect;  // output format
+    bool arrow = false;  // Arrow IPC streams instead of text
+    SheetFilter sheets;  // sheets to convert, default all
+    string inner;        // if set, the workbook is this member of each input archive
+};
+
+// loads member "name" of archive "fname" into memory ("-": stdin, read front to back). Its length goes to "length".
+std::unique_ptr<char, void (*)(void*)> loadMember(const string& fname, const string& name, bool mmapped, size_t* length) {
+    std::unique_ptr<char, void (*)(void*)> buf(NULL, free);
+    if (fname == "-") {
+        // === grows by doubling: the size is known only at the end of the member ===
+        size_t capacity = 0;
+        *length = 0;
+        auto append = [&](const char* data, size_t n) {
+            if (*length + n > capacity) {
+                const size_t wanted = std::max(2 * capacity, *length + n) + 65536;
+                char* grown = (char*)realloc(buf.get(), wanted);
+                if (!grown) return false;
+                buf.release();
+                buf.reset(grown);
+                capacity = wanted;
+            }
+            memcpy(buf.get() + *length, data, n);
+            *length += n;
+            return true;
+        };
+        if (!unzipForward(fname.c_str(), name.c_str(), mmapped, append)) throw runtime_error("unzip failed for " + name + " in '" + fname + "'");
+        return buf;
+    }
+    buf.reset(unzipToBuf(fname.c_str(), name.c_str(), mmapped, length));
+    if (!buf) throw runtime_error("unzip failed for " + name + " in '" + fname + "'");
+    return buf;
+}
+
+// converts one workbook to the output format on "out"
+void convertFile(const string& fname, const Options& opts, OutSink& out) {
+    SheetWriter writer(out, opts.dialect);
+    ArrowWriter arrowWriter(out, opts.dialect.values);
+    auto emit = [&](const string& name, const Sheet& table) {
+        if (opts.arrow)
+            arrowWriter.writeSheet(name, table);
+        else
+            writeTable(writer, name, table);
+    };
+    if (!opts.inner.empty()) {
+        // === nested workbook: inflated into memory and converted from there ===
+        size_t length = 0;
+        const std::unique_ptr<char, void (*)(void*)> inner = loadMember(fname, opts.inner, opts.mmapped, &length);
+        for (const auto& tableInBook : ods2txt_buffer(inner.get(), length, opts.sheets))
+            emit(tableInBook.first, tableInBook.second);
+        return;
+    }
+    const bool stream = opts.stream || fname == "-";  // stdin can only be read front to back
+    if (stream && opts.arrow) {
+        // === columns need the whole sheet ===
+        SheetCollector handler(emit);
+        ods2txt_stream(fname, handler, opts.pipelined, opts.mmapped, opts.sheets);
+        return;
+    }
+    if (stream) {
+        StreamingSheetWriter handler(writer);
+        ods2txt_stream(fname, handler, opts.pipelined, opts.mmapped, opts.sheets);
+        return;
+    }
+    if (opts.parallelSheets) {
+        ods2txt_parallel(fname, opts.mmapped, opts.nWorkers, opts.parallelRows, emit, opts.sheets);
+        return;
+    }
 
-    map<string, map<size_t, map<size_t, string>>> bookData = ods2txt_sparse(fname);
+    map<string, Sheet> bookData = ods2txt_sparse(fname, opts.mmapped, opts.sheets);
 
     // === iterate over sheets ===
-    for (const auto& tableInBook : bookData) {
-        const string& tableName = tableInBook.first;
-        const map<size_t, map<size_t, string>>& tableData = tableInBook.second;
-
-        cout << "$NEW_SHEET," << tableName << sepRow;
-        size_t lastTerminatedIxRow = 0;
-
-        // === iterate over rows ===
-        for (const auto& rowInSheet : tableData) {
-            size_t ixRow = rowInSheet.first;
-            const map<size_t, string>& rowData = rowInSheet.second;
-            if (rowData.size() < 1) continue;  // defer output of possibly trailing separators
-
-            // === write row separators ===
-            for (size_t ix = lastTerminatedIxRow; ix < ixRow; ++ix)
-                cout << sepRow;
-            lastTerminatedIxRow = ixRow;
-            size_t lastTerminatedIxCol = 0;
-
-            // === iterate over columns ===
-            for (auto& cellInRow : rowData) {
-                size_t ixCol = cellInRow.first;
-                const string& cellText = cellInRow.second;
-                if (cellText.size() < 1) continue;  // defer output of possibly trailing separators
-
-                // === write column separators ===
-                for (size_t ix = lastTerminatedIxCol; ix < ixCol; ++ix)
-                    cout << sepCol;
-                lastTerminatedIxCol = ixCol;
-
-                // === write cell content ===
-                cout << cellText;
+    for (const auto& tableInBook : bookData)
+        emit(tableInBook.first, tableInBook.second);
+}
+
+/* Output file of each of "fnames" in "outDir": outDir/<name without extension><ext>, "stdin" for "-".
+   Throws if two inputs would share one, e.g. c1/x.ods and c2/x.ods.
+*/
+vector<string> outputPaths(const vector<string>& fnames, const string& outDir, const string& ext) {
+    vector<string> outPaths(fnames.size());
+    map<string, size_t> inputOf;
+    for (size_t ix = 0; ix < fnames.size(); ++ix) {
+        string base = fnames[ix].substr(fnames[ix].find_last_of('/') + 1);
+        base = base == "-" ? "stdin" : base.substr(0, base.find_last_of('.'));
+        outPaths[ix] = outDir + "/" + base + ext;
+        const auto v = inputOf.insert({outPaths[ix], ix});
+        if (!v.second) throw runtime_error("'" + fnames[v.first->second] + "' and '" + fnames[ix] + "' would both be written to '" + outPaths[ix] + "'");
+    }
+    return outPaths;
+}
+
+/* Converts "fnames" on up to "opts.nWorkers" threads, each with its own archive handle and parser state.
+   Without "outDir", results go to stdout in input order: a finished file is written once all files before it are written.
+   With "outDir", each file goes to outDir/<name without extension>.csv (.arrow for Arrow output); inputs whose names
+   would collide there are reported, and nothing is converted.
+   Failures are reported on stderr and don't stop the other files. Returns the number of failed files.
+   A single worker writes to stdout directly, keeping the memory of streaming conversions bounded.
+   With several files, the threads are shared out among the file workers and --parallel-sheets inside each file.
+*/
+size_t convertFiles(const vector<string>& fnames, const Options& opts, const string& outDir) {
+    size_t nFailed = 0;
+    OutSink out(STDOUT_FILENO);
+    const size_t nFileWorkers = std::max<size_t>(1, std::min(opts.nWorkers, fnames.size()));
+    Options fileOpts = opts;
+    fileOpts.nWorkers = std::max<size_t>(1, opts.nWorkers / nFileWorkers);
+    if (outDir.empty() && nFileWorkers == 1) {
+        for (const string& fname : fnames) {
+            try {
+                convertFile(fname, fileOpts, out);
+            } catch (const std::exception& e) {
+                std::cerr << "ods2csv: " << fname << ": " << e.what() << endl;
+                ++nFailed;
             }
-            cout << sepRow;
-            lastTerminatedIxRow = ixRow;
-        }  // for rowInSheet
+        }
+        out.close();
+        return nFailed;
+    }
 
-        cout << "$END_SHEET" << sepRow;
-    }  // for table in sheet
+    // === output paths, decided before any work ===
+    vector<string> outPaths;
+    try {
+        if (!outDir.empty()) outPaths = outputPaths(fnames, outDir, opts.arrow ? ".arrow" : ".csv");
+    } catch (const std::exception& e) {
+        std::cerr << "ods2csv: " << e.what() << endl;
+        return fnames.size();
+    }
 
-    return 0;
-}
\ No newline at end of file
+    vector<string> results(fnames.size());
+    vector<string> errors(fnames.size());
+    runOrdered(
+        fnames.size(), nFileWorkers,
+        /*work*/ [&](size_t ix) {
+            try {
+                if (outDir.empty()) {
+                    OutSink os(&results[ix]);
+                    convertFile(fnames[ix], fileOpts, os);
+                    os.close();
+                } else {
+                    OutSink os(outPaths[ix]);
+                    convertFile(fnames[ix], fileOpts, os);
+                    os.close();
+                }
+            } catch (const std::exception& e) {
+                errors[ix] = e.what();
+            }
+        },
+        /*emit*/ [&](size_t ix) {
+            if (!errors[ix].empty()) {
+                std::cerr << "ods2csv: " << fnames[ix] << ": " << errors[ix] << endl;
+                ++nFailed;
+            }
+            out.put(results[ix]);
+            out.flush();
+            results[ix] = string();  // release memory
+        });
+    out.close();
+    return nFailed;
+}
+
+#ifndef ODS2CSV_NO_MAIN  // defined by programs that reuse the converter, e.g. bench/
+int main(int argc, const char** argv) {
+    if (argc < 1) throw runtime_error("??? cmd line args: executable location is missing ???");
+    std::ios::sync_with_stdio(false);  // stdout goes through OutSink; the remaining streams needn't sync with stdio
+    vector<string> fnames;
+    Options opts;
+    string outDir;
+    size_t head = 0;
+    bool listFromStdin = false;
+    for (int ixArg = 1; ixArg < argc; ++ixArg) {
+        const string arg = argv[ixArg];
+        if (arg == "--stream") {
+            opts.stream = true;
+        } else if (arg == "--pipeline") {
+            opts.stream = opts.pipelined = true;
+        } else if (arg == "--mmap") {
+            opts.mmapped = true;
+        } else if (arg == "--parallel-sheets") {
+            opts.parallelSheets = true;
+        } else if (arg == "--parallel-rows") {
+            opts.parallelSheets = opts.parallelRows = true;
+        } else if (arg == "--arrow") {
+            opts.arrow = true;
+        } else if (arg == "--values") {
+            opts.dialect.values = true;
+        } else if (arg == "--csv") {
+            opts.dialect.legacy = false;
+        } else if (arg == "--tsv") {
+            opts.dialect.legacy = false;
+            opts.dialect.sepCol = '\t';
+        } else if (arg == "--crlf") {
+            opts.dialect.legacy = false;
+            opts.dialect.sepRow = "\r\n";
+        } else if (arg == "--sep" || arg == "--quote" || arg == "--quoting") {
+            if (++ixArg >= argc) throw runtime_error("option '" + arg + "' needs an argument");
+            string val = argv[ixArg];
+            if (val == "\\t") val = "\t";
+            opts.dialect.legacy = false;
+            if (arg == "--quoting") {
+                if (val == "minimal")
+                    opts.dialect.quoting = CsvDialect::QUOTE_MINIMAL;
+                else if (val == "all")
+                    opts.dialect.quoting = CsvDialect::QUOTE_ALL;
+                else if (val == "none")
+                    opts.dialect.quoting = CsvDialect::QUOTE_NONE;
+                else
+                    throw runtime_error("option '--quoting' needs minimal, all or none");
+            } else {
+                if (val.size() != 1 || val[0] == '\r' || val[0] == '\n') throw runtime_error("option '" + arg + "' needs a single character");
+                (arg == "--sep" ? opts.dialect.sepCol : opts.dialect.quote) = val[0];
+            }
+        } else if (arg == "-j" || arg == "--outdir" || arg == "--files-from" || arg == "--sheet" || arg == "--sheet-index" || arg == "--range" || arg == "--head" || arg == "--inner") {
+            if (++ixArg >= argc) throw runtime_error("option '" + arg + "' needs an argument");
+            const string val = argv[ixArg];
+            if (arg == "-j") {
+                opts.nWorkers = std::atol(val.c_str());
+            } else if (arg == "--sheet") {
+                if (!opts.sheets.isNamed(val)) opts.sheets.names.push_back(val);
+            } else if (arg == "--sheet-index") {
+                const long ix = std::atol(val.c_str());
+                if (ix < 1) throw runtime_error("option '--sheet-index' needs a number from 1");
+                opts.sheets.indices.push_back(ix);
+            } else if (arg == "--range") {
+                opts.sheets.range = CellRange::parse(val);
+            } else if (arg == "--head") {
+                const long n = std::atol(val.c_str());
+                if (n < 1) throw runtime_error("option '--head' needs a number from 1");
+                head = n;
+            } else if (arg == "--inner") {
+                opts.inner = val;
+            } else if (arg == "--outdir") {
+                outDir = val;
+            } else {
+                // === one file name per line, "-" reads the list from stdin ===
+                std::ifstream listFile;
+                listFromStdin |= val == "-";
+                if (val != "-") {
+                    listFile.open(val);
+                    if (!listFile) throw runtime_error("cannot open file list '" + val + "'");
+                }
+                std::istream& list = val == "-" ? std::cin : listFile;
+                string line;
+                while (std::getline(list, line))
+                    if (!line.empty()) fnames.push_back(line);
+            }
+        } else if (arg.size() > 1 && arg[0] == '-') {
+            throw runtime_error("unknown option '" + arg + "'");
+        } else {
+            fnames.push_back(arg);
+        }
+    }
+    if (head > 0) {
+        // === preview: the first rows of the selected sheets (default: the first sheet), streamed. Inflating stops once they are out ===
+        if (opts.sheets.all()) opts.sheets.indices.push_back(1);
+        CellRange& range = opts.sheets.range;
+        range.rowEnd = std::min(range.rowEnd, range.rowBegin + std::min(head, SIZE_MAX - range.rowBegin));
+        opts.stream = true;
+        opts.parallelSheets = opts.parallelRows = false;
+    }
+    if (std::count(fnames.begin(), fnames.end(), "-") + listFromStdin > 1) throw runtime_error("stdin ('-') can be read only once");
+    if (fnames.empty()) throw runtime_error("need argument(s) 'inputfile.ods' (openOffice spreadsheet) or --files-from LIST, optionally --stream or --pipeline or --parallel-sheets or --parallel-rows, --mmap, -j N, --outdir DIR, --sheet NAME, --sheet-index N, --range A1:F5000, --head N, --inner NAME, - for stdin, --csv or --tsv with --sep C, --quote C, --quoting minimal|all|none, --crlf, --values, --arrow");
+
+    return convertFiles(fnames, opts, outDir) ? 1 : 0;
+}
+#endif
@@ -0,0 +1,43 @@
+/* iomem.c -- in-memory IO functions for unzip, see iomem.h
+*/
+
+#include <stdlib.h>
+
+#include "iomem.h"
+
+static voidpf ZCALLBACK mem_open64_file_func (voidpf opaque, const void* filename, int mode)
+{
+    const mem_source* src = (const mem_source*)filename;
+    mmap_file* mf;
+    if ((src==NULL) || ((src->base==NULL) && (src->size>0)) ||
+        ((mode & ZLIB_FILEFUNC_MODE_READWRITEFILTER)!=ZLIB_FILEFUNC_MODE_READ))
+        return NULL;
+
+    mf = (mmap_file*)malloc(sizeof(mmap_file));
+    if (mf == NULL)
+        return NULL;
+    mf->base = (const char*)src->base;
+    mf->size = src->size;
+    mf->pos = 0;
+
+    if (opaque != NULL)
+        *(const mmap_file**)opaque = mf;
+    return mf;
+}
+
+static int ZCALLBACK mem_close_file_func (voidpf opaque, voidpf stream)
+{
+    mmap_file* mf = (mmap_file*)stream;
+    if ((opaque != NULL) && (*(const mmap_file**)opaque == mf))
+        *(const mmap_file**)opaque = NULL;
+    free(mf); /* the buffer belongs to the caller */
+    return 0;
+}
+
+void fill_mem_filefunc64 (zlib_filefunc64_def* pzlib_filefunc_def, const mmap_file** last_opened)
+{
+    /* reading, seeking and telling work on the mmap_file view alike; only opening and closing differ */
+    fill_mmap_filefunc64(pzlib_filefunc_def, last_opened);
+    pzlib_filefunc_def->zopen64_file = mem_open64_file_func;
+    pzlib_filefunc_def->zclose_file = mem_close_file_func;
+}
@@ -0,0 +1,32 @@
+/* iomem.h -- in-memory IO functions for unzip
+   Reads an archive that is already in memory, e.g. a member of an outer archive or a message payload, without a
+   file. The archive is seen through the same mmap_file view as a mapped file (iommap.h), so that callers can access
+   member data in place alike.
+*/
+
+#ifndef _ZLIBIOMEM_H
+#define _ZLIBIOMEM_H
+
+#include "iommap.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* the archive in memory, passed as "path" to unzOpen2_64. The buffer must outlive the handle; the descriptor
+   itself is only read while opening. */
+typedef struct mem_source_s
+{
+    const void* base;
+    ZPOS64_T size;
+} mem_source;
+
+/* Fills pzlib_filefunc_def with the functions reading from a mem_source (read mode only).
+   If last_opened is not NULL, it receives the view of the archive opened last, see fill_mmap_filefunc64(). */
+void fill_mem_filefunc64 OF((zlib_filefunc64_def* pzlib_filefunc_def, const mmap_file** last_opened));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,137 @@
+/* iommap.c -- memory-mapped IO functions for unzip, see iommap.h
+*/
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "iommap.h"
+
+static voidpf ZCALLBACK mmap_open64_file_func (voidpf opaque, const void* filename, int mode)
+{
+    mmap_file* mf;
+    struct stat st;
+    int fd;
+    if ((filename==NULL) || ((mode & ZLIB_FILEFUNC_MODE_READWRITEFILTER)!=ZLIB_FILEFUNC_MODE_READ))
+        return NULL;
+
+    fd = open((const char*)filename, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        return NULL;
+    }
+
+    mf = (mmap_file*)malloc(sizeof(mmap_file));
+    if (mf == NULL)
+    {
+        close(fd);
+        return NULL;
+    }
+    mf->base = NULL;
+    mf->size = (ZPOS64_T)st.st_size;
+    mf->pos = 0;
+    if (mf->size > 0)
+    {
+        void* p = mmap(NULL, (size_t)mf->size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED)
+        {
+            free(mf);
+            close(fd);
+            return NULL;
+        }
+        mf->base = (const char*)p;
+    }
+    close(fd); /* the mapping keeps the file referenced */
+
+    if (opaque != NULL)
+        *(const mmap_file**)opaque = mf;
+    return mf;
+}
+
+static uLong ZCALLBACK mmap_read_file_func (voidpf opaque, voidpf stream, void* buf, uLong size)
+{
+    mmap_file* mf = (mmap_file*)stream;
+    ZPOS64_T avail = mf->pos < mf->size ? mf->size - mf->pos : 0;
+    (void)opaque;
+    if (size > avail)
+        size = (uLong)avail;
+    if (size > 0)
+        memcpy(buf, mf->base + mf->pos, size);
+    mf->pos += size;
+    return size;
+}
+
+static uLong ZCALLBACK mmap_write_file_func (voidpf opaque, voidpf stream, const void* buf, uLong size)
+{
+    (void)opaque;
+    (void)stream;
+    (void)buf;
+    (void)size;
+    return 0; /* read only */
+}
+
+static ZPOS64_T ZCALLBACK mmap_tell64_file_func (voidpf opaque, voidpf stream)
+{
+    (void)opaque;
+    return ((mmap_file*)stream)->pos;
+}
+
+static long ZCALLBACK mmap_seek64_file_func (voidpf opaque, voidpf stream, ZPOS64_T offset, int origin)
+{
+    mmap_file* mf = (mmap_file*)stream;
+    ZPOS64_T newPos;
+    (void)opaque;
+    switch (origin)
+    {
+    case ZLIB_FILEFUNC_SEEK_CUR :
+        newPos = mf->pos + offset;
+        break;
+    case ZLIB_FILEFUNC_SEEK_END :
+        newPos = mf->size + offset;
+        break;
+    case ZLIB_FILEFUNC_SEEK_SET :
+        newPos = offset;
+        break;
+    default: return -1;
+    }
+    if (newPos > mf->size)
+        return -1;
+    mf->pos = newPos;
+    return 0;
+}
+
+static int ZCALLBACK mmap_close_file_func (voidpf opaque, voidpf stream)
+{
+    mmap_file* mf = (mmap_file*)stream;
+    int ret = 0;
+    if (mf->base != NULL)
+        ret = munmap((void*)mf->base, (size_t)mf->size);
+    if ((opaque != NULL) && (*(const mmap_file**)opaque == mf))
+        *(const mmap_file**)opaque = NULL;
+    free(mf);
+    return ret;
+}
+
+static int ZCALLBACK mmap_error_file_func (voidpf opaque, voidpf stream)
+{
+    (void)opaque;
+    (void)stream;
+    return 0;
+}
+
+void fill_mmap_filefunc64 (zlib_filefunc64_def* pzlib_filefunc_def, const mmap_file** last_opened)
+{
+    pzlib_filefunc_def->zopen64_file = mmap_open64_file_func;
+    pzlib_filefunc_def->zread_file = mmap_read_file_func;
+    pzlib_filefunc_def->zwrite_file = mmap_write_file_func;
+    pzlib_filefunc_def->ztell64_file = mmap_tell64_file_func;
+    pzlib_filefunc_def->zseek64_file = mmap_seek64_file_func;
+    pzlib_filefunc_def->zclose_file = mmap_close_file_func;
+    pzlib_filefunc_def->zerror_file = mmap_error_file_func;
+    pzlib_filefunc_def->opaque = (voidpf)last_opened;
+}
@@ -0,0 +1,34 @@
+/* iommap.h -- memory-mapped IO functions for unzip
+   Read-only alternative to the stdio functions in ioapi.c: the whole archive is mapped with mmap(),
+   reads are served straight from the page cache without stdio buffering.
+*/
+
+#ifndef _ZLIBIOMMAP_H
+#define _ZLIBIOMMAP_H
+
+#include "ioapi.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* one mapped archive, returned as "filestream" by the open function */
+typedef struct mmap_file_s
+{
+    const char* base;   /* start of the mapping (NULL for an empty file) */
+    ZPOS64_T size;      /* length of the file */
+    ZPOS64_T pos;       /* current read position */
+} mmap_file;
+
+/* Fills pzlib_filefunc_def with the mmap-based functions (read mode only).
+   If last_opened is not NULL, it receives the mapping of the file opened last. It remains valid until that
+   file is closed, so that a caller can access member data in place, e.g. STORED members at
+   unzGetCurrentFileZStreamPos64(). fill_mem_filefunc64() (iomem.h) starts from these functions and replaces
+   opening and closing. */
+void fill_mmap_filefunc64 OF((zlib_filefunc64_def* pzlib_filefunc_def, const mmap_file** last_opened));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
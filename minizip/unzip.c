@@ -160,6 +160,27 @@ typedef struct
 } file_in_zip64_read_info_s;
 
 
+/* unz64_name_index contains the names of the files in the zipfile, hashed
+    for unzLocateFile. It is built from a single read of the central dir */
+typedef struct
+{
+    ZPOS64_T pos_in_central_dir;   /* pos of the file in the central dir */
+    ZPOS64_T num_file;             /* number of the file in the zipfile */
+    uLong hash;                    /* of the name, with ASCII case folded */
+    uLong name_offset;             /* of the name in names */
+} unz64_name_entry;
+
+typedef struct
+{
+    unz64_name_entry* entries;     /* in central dir order */
+    ZPOS64_T* slots;               /* open addressing, linear probing:
+                                      1 + index in entries, 0 if empty */
+    ZPOS64_T n_slots;              /* a power of 2, at least twice the
+                                      number of entries */
+    char* names;                   /* null terminated, one after the other */
+} unz64_name_index;
+
+
 /* unz64_s contain internal information about the zipfile
 */
 typedef struct
@@ -186,6 +207,9 @@ typedef struct
 
     int isZip64;
 
+    unz64_name_index* name_index;  /* NULL if the central dir could not be
+                                      indexed: unzLocateFile then scans it */
+
 #    ifndef NOUNCRYPT
     unsigned long keys[3];     /* keys defining the pseudo-random sequence */
     const z_crc_t* pcrc_32_tab;
@@ -401,6 +425,34 @@ extern int ZEXPORT unzStringFileNameCompare (const char*  fileName1,
     return STRCMPCASENOSENTIVEFUNCTION(fileName1,fileName2);
 }
 
+/*
+   Hash of a file name for the name index (FNV-1a), with ASCII letters
+   folded, so that names differing only in case have the same hash.
+*/
+local uLong unz64local_NameHash (const char* name, uLong size_name)
+{
+    uLong hash = 2166136261UL;
+    uLong i;
+    for (i=0;i<size_name;i++)
+    {
+        unsigned char c = (unsigned char)name[i];
+        if ((c>='a') && (c<='z'))
+            c -= 0x20;
+        hash = ((hash ^ c) * 16777619UL) & 0xffffffffUL;
+    }
+    return hash;
+}
+
+local void unz64local_FreeNameIndex (unz64_name_index* index)
+{
+    if (index==NULL)
+        return;
+    TRYFREE(index->entries);
+    TRYFREE(index->slots);
+    TRYFREE(index->names);
+    TRYFREE(index);
+}
+
 #ifndef BUFREADCOMMENT
 #define BUFREADCOMMENT (0x400)
 #endif
@@ -581,6 +633,103 @@ local ZPOS64_T unz64local_SearchCentralDir64(const zlib_filefunc64_32_def* pzlib
      Else, the return value is a unzFile Handle, usable with other function
        of this unzip package.
 */
+/*
+  Read the central directory with a single read and index the names of the
+  files in it. Return NULL if that fails (the directory is then scanned by
+  unzLocateFile as before).
+*/
+local unz64_name_index* unz64local_BuildNameIndex (const unz64_s* us)
+{
+    unz64_name_index* index = NULL;
+    unsigned char* dir;
+    ZPOS64_T size_dir = us->size_central_dir;
+    ZPOS64_T pos;
+    ZPOS64_T n_entries = 0;
+    ZPOS64_T size_names = 0;
+    ZPOS64_T i;
+    int ok;
+
+    if ((size_dir==0) || (size_dir!=(uLong)size_dir))
+        return NULL;
+    dir = (unsigned char*)ALLOC((uLong)size_dir);
+    if (dir==NULL)
+        return NULL;
+    ok = (ZSEEK64(us->z_filefunc, us->filestream,
+                  us->offset_central_dir + us->byte_before_the_zipfile,
+                  ZLIB_FILEFUNC_SEEK_SET)==0) &&
+         (ZREAD64(us->z_filefunc, us->filestream, dir, (uLong)size_dir)==size_dir);
+
+    /* count the entries as unzGoToNextFile would walk them */
+#define UNZ_DIR_SHORT(p) ((uLong)(p)[0] | ((uLong)(p)[1]<<8))
+#define UNZ_DIR_LONG(p) (UNZ_DIR_SHORT(p) | (UNZ_DIR_SHORT((p)+2)<<16))
+    pos = 0;
+    while (ok && (pos+SIZECENTRALDIRITEM<=size_dir) &&
+           (UNZ_DIR_LONG(dir+pos)==0x02014b50))
+    {
+        size_names += UNZ_DIR_SHORT(dir+pos+28) + 1;
+        pos += SIZECENTRALDIRITEM + UNZ_DIR_SHORT(dir+pos+28) +
+               UNZ_DIR_SHORT(dir+pos+30) + UNZ_DIR_SHORT(dir+pos+32);
+        n_entries++;
+        if ((us->gi.number_entry!=0xffff) && (n_entries==us->gi.number_entry))
+            break;
+    }
+    ok = ok && (pos<=size_dir) && (n_entries>0) &&
+         ((us->gi.number_entry==0xffff) || (n_entries==us->gi.number_entry));
+
+    if (ok)
+    {
+        index = (unz64_name_index*)ALLOC(sizeof(unz64_name_index));
+        ok = (index!=NULL);
+    }
+    if (ok)
+    {
+        index->n_slots = 16;
+        while (index->n_slots < 2*n_entries)
+            index->n_slots *= 2;
+        index->entries = (unz64_name_entry*)ALLOC(n_entries*sizeof(unz64_name_entry));
+        index->slots = (ZPOS64_T*)ALLOC(index->n_slots*sizeof(ZPOS64_T));
+        index->names = (char*)ALLOC(size_names);
+        ok = (index->entries!=NULL) && (index->slots!=NULL) && (index->names!=NULL);
+        if (!ok)
+        {
+            unz64local_FreeNameIndex(index);
+            index = NULL;
+        }
+    }
+    if (ok)
+    {
+        ZPOS64_T name_offset = 0;
+        memset(index->slots,0,index->n_slots*sizeof(ZPOS64_T));
+        pos = 0;
+        for (i=0;i<n_entries;i++)
+        {
+            const uLong size_filename = UNZ_DIR_SHORT(dir+pos+28);
+            unz64_name_entry* entry = index->entries+i;
+            ZPOS64_T slot;
+            entry->pos_in_central_dir = us->offset_central_dir + pos;
+            entry->num_file = i;
+            entry->hash = unz64local_NameHash((const char*)dir+pos+SIZECENTRALDIRITEM,size_filename);
+            entry->name_offset = (uLong)name_offset;
+            memcpy(index->names+name_offset,dir+pos+SIZECENTRALDIRITEM,size_filename);
+            index->names[name_offset+size_filename] = '\0';
+            name_offset += size_filename + 1;
+
+            /* later duplicates probe past earlier ones: the first is found */
+            slot = entry->hash & (index->n_slots-1);
+            while (index->slots[slot]!=0)
+                slot = (slot+1) & (index->n_slots-1);
+            index->slots[slot] = i+1;
+
+            pos += SIZECENTRALDIRITEM + size_filename +
+                   UNZ_DIR_SHORT(dir+pos+30) + UNZ_DIR_SHORT(dir+pos+32);
+        }
+    }
+#undef UNZ_DIR_SHORT
+#undef UNZ_DIR_LONG
+    TRYFREE(dir);
+    return index;
+}
+
 local unzFile unzOpenInternal (const void *path,
                                zlib_filefunc64_32_def* pzlib_filefunc64_32_def,
                                int is64bitOpenFunction)
@@ -752,12 +901,17 @@ local unzFile unzOpenInternal (const void *path,
     us.encrypted = 0;
 
 
+    us.name_index = unz64local_BuildNameIndex(&us);
+
+
     s=(unz64_s*)ALLOC(sizeof(unz64_s));
     if( s != NULL)
     {
         *s=us;
         unzGoToFirstFile((unzFile)s);
     }
+    else
+        unz64local_FreeNameIndex(us.name_index);
     return (unzFile)s;
 }
 
@@ -816,6 +970,7 @@ extern int ZEXPORT unzClose (unzFile file)
         unzCloseCurrentFile(file);
 
     ZCLOSE64(s->z_filefunc, s->filestream);
+    unz64local_FreeNameIndex(s->name_index);
     TRYFREE(s);
     return UNZ_OK;
 }
@@ -1228,6 +1383,7 @@ extern int ZEXPORT unzGoToNextFile (unzFile  file)
   return value :
   UNZ_OK if the file is found. It becomes the current file.
   UNZ_END_OF_LIST_OF_FILE if the file is not found
+  The names are looked up in the index built by unzOpen, if there is one.
 */
 extern int ZEXPORT unzLocateFile (unzFile file, const char *szFileName, int iCaseSensitivity)
 {
@@ -1259,9 +1415,36 @@ extern int ZEXPORT unzLocateFile (unzFile file, const char *szFileName, int iCas
     cur_file_infoSaved = s->cur_file_info;
     cur_file_info_internalSaved = s->cur_file_info_internal;
 
-    err = unzGoToFirstFile(file);
+    if (s->name_index!=NULL)
+    {
+        /* hashed: one probe sequence, then only the entry found is read */
+        const unz64_name_index* index = s->name_index;
+        const uLong hash = unz64local_NameHash(szFileName,(uLong)strlen(szFileName));
+        ZPOS64_T slot = hash & (index->n_slots-1);
+        err = UNZ_END_OF_LIST_OF_FILE;
+        for (; index->slots[slot]!=0; slot = (slot+1) & (index->n_slots-1))
+        {
+            const unz64_name_entry* entry = index->entries + (index->slots[slot]-1);
+            if ((entry->hash==hash) &&
+                (unzStringFileNameCompare(index->names+entry->name_offset,
+                                            szFileName,iCaseSensitivity)==0))
+            {
+                s->pos_in_central_dir = entry->pos_in_central_dir;
+                s->num_file = entry->num_file;
+                err = unz64local_GetCurrentFileInfoInternal(file,&s->cur_file_info,
+                                                           &s->cur_file_info_internal,
+                                                           NULL,0,NULL,0,NULL,0);
+                s->current_file_ok = (err == UNZ_OK);
+                if (err == UNZ_OK)
+                    return UNZ_OK;
+                break;
+            }
+        }
+    }
+    else
+        err = unzGoToFirstFile(file);
 
-    while (err == UNZ_OK)
+    while ((s->name_index==NULL) && (err == UNZ_OK))
     {
         char szCurrentFileName[UNZ_MAXFILENAMEINZIP+1];
         err = unzGetCurrentFileInfo64(file,NULL,
@@ -1888,6 +2071,111 @@ extern int ZEXPORT unzReadCurrentFile  (unzFile file, voidp buf, unsigned len)
 }
 
 
+/*
+  Read the whole current file in one go: one read of the compressed data
+  (or none, if the caller has it in memory), one inflate(Z_FINISH) call
+  straight into buf. See unzip.h
+*/
+extern int ZEXPORT unzReadCurrentFileAll (unzFile file, const void* compressed,
+                                          voidp buf, ZPOS64_T len, ZPOS64_T* pread)
+{
+    int err=UNZ_OK;
+    unz64_s* s;
+    file_in_zip64_read_info_s* pfile_in_zip_read_info;
+    ZPOS64_T size_compressed;
+    ZPOS64_T size_uncompressed;
+    voidp read_buffer = NULL;
+    uLong crc;
+    if ((file==NULL) || (buf==NULL) || (pread==NULL))
+        return UNZ_PARAMERROR;
+    s=(unz64_s*)file;
+    pfile_in_zip_read_info=s->pfile_in_zip_read;
+    if ((pfile_in_zip_read_info==NULL) || (pfile_in_zip_read_info->read_buffer==NULL))
+        return UNZ_PARAMERROR;
+
+    /* only a member not read from yet, whose sizes fit zlib's uInt counters */
+    size_compressed = s->cur_file_info.compressed_size;
+    size_uncompressed = s->cur_file_info.uncompressed_size;
+    if ((pfile_in_zip_read_info->raw) || (s->encrypted) ||
+        (pfile_in_zip_read_info->total_out_64!=0) ||
+        (pfile_in_zip_read_info->stream.avail_in!=0) ||
+        (pfile_in_zip_read_info->rest_read_compressed!=size_compressed) ||
+        (size_uncompressed>len) ||
+        (size_compressed>(uInt)-1) || (size_uncompressed>(uInt)-1))
+        return UNZ_PARAMERROR;
+    if (pfile_in_zip_read_info->compression_method==0)
+    {
+        if (size_compressed!=size_uncompressed)
+            return UNZ_PARAMERROR;
+    }
+    else if ((pfile_in_zip_read_info->compression_method!=Z_DEFLATED) ||
+             (pfile_in_zip_read_info->stream_initialised!=Z_DEFLATED))
+        return UNZ_PARAMERROR;
+
+    /* the compressed data, with a single read. STORED data is read into buf */
+    if ((compressed==NULL) && (size_compressed>0))
+    {
+        voidp dest = buf;
+        if (pfile_in_zip_read_info->compression_method!=0)
+        {
+            read_buffer = ALLOC(size_compressed);
+            if (read_buffer==NULL)
+                return UNZ_INTERNALERROR;
+            dest = read_buffer;
+        }
+        if ((ZSEEK64(pfile_in_zip_read_info->z_filefunc,
+                     pfile_in_zip_read_info->filestream,
+                     pfile_in_zip_read_info->pos_in_zipfile +
+                        pfile_in_zip_read_info->byte_before_the_zipfile,
+                     ZLIB_FILEFUNC_SEEK_SET)!=0) ||
+            (ZREAD64(pfile_in_zip_read_info->z_filefunc,
+                     pfile_in_zip_read_info->filestream,
+                     dest, (uLong)size_compressed)!=size_compressed))
+            err=UNZ_ERRNO;
+        compressed = dest;
+    }
+
+    if ((err==UNZ_OK) && (pfile_in_zip_read_info->compression_method==0))
+    {
+        if ((size_compressed>0) && (compressed!=buf))
+            memcpy(buf,compressed,(size_t)size_compressed);
+        *pread = size_compressed;
+    }
+    else if (err==UNZ_OK)
+    {
+        z_stream* stream = &pfile_in_zip_read_info->stream;
+        const uInt avail_out = (uInt)(len<(uInt)-1 ? len : (uInt)-1);
+        stream->next_in = (Bytef*)compressed;
+        stream->avail_in = (uInt)size_compressed;
+        stream->next_out = (Bytef*)buf;
+        stream->avail_out = avail_out;
+        err=inflate(stream,Z_FINISH);
+        *pread = avail_out - stream->avail_out;
+        stream->next_in = Z_NULL;
+        stream->avail_in = 0;
+        if (err==Z_STREAM_END)
+            err=UNZ_OK;
+        else if ((err==Z_OK) || (err==Z_BUF_ERROR))
+            err=UNZ_BADZIPFILE; /* truncated, or larger than buf */
+    }
+    TRYFREE(read_buffer);
+    if (err!=UNZ_OK)
+        return err;
+    if (*pread!=size_uncompressed)
+        return UNZ_BADZIPFILE;
+
+    /* as after reading with unzReadCurrentFile, for unzCloseCurrentFile */
+    crc = crc32(0L,(const Bytef*)buf,(uInt)*pread);
+    pfile_in_zip_read_info->crc32 = crc;
+    pfile_in_zip_read_info->total_out_64 = *pread;
+    pfile_in_zip_read_info->rest_read_compressed = 0;
+    pfile_in_zip_read_info->rest_read_uncompressed = 0;
+    if (crc!=pfile_in_zip_read_info->crc32_wait)
+        return UNZ_CRCERROR;
+    return UNZ_OK;
+}
+
+
 /*
   Give the current position in uncompressed data
 */
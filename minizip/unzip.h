@@ -249,6 +249,8 @@ extern int ZEXPORT unzLocateFile OF((unzFile file,
   return value :
   UNZ_OK if the file is found. It becomes the current file.
   UNZ_END_OF_LIST_OF_FILE if the file is not found
+  unzOpen reads the central directory once and hashes the names in it, so a
+  lookup costs about the same for any number of files in the zipfile.
 */
 
 
@@ -390,6 +392,33 @@ extern int ZEXPORT unzReadCurrentFile OF((unzFile file,
     (UNZ_ERRNO for IO error, or zLib error for uncompress error)
 */
 
+extern int ZEXPORT unzReadCurrentFileAll OF((unzFile file,
+                      const void* compressed,
+                      voidp buf,
+                      ZPOS64_T len,
+                      ZPOS64_T* pread));
+/*
+  Read the whole current file (opened by unzOpenCurrentFile, nothing read yet)
+  in one go, bypassing the read buffer: the compressed data is read with a
+  single read call and inflated with a single inflate(Z_FINISH) call straight
+  into buf. STORED data is read into buf directly.
+  compressed may point to the compressed data if the caller already has it in
+  memory (e.g. a mapping of the archive at unzGetCurrentFileZStreamPos64()),
+  else it is NULL.
+  len is the size of buf, which must hold the uncompressed size from the
+  directory. *pread receives the number of bytes read; the CRC is checked.
+
+  return UNZ_OK if the file was read completely
+  return UNZ_PARAMERROR if the file does not qualify (encrypted, raw, already
+    read from, other compression method, sizes beyond 4 GB, buf too small);
+    nothing was consumed then
+  return UNZ_BADZIPFILE if the data ends early or its size is not the one in
+    the directory
+  return UNZ_CRCERROR if the data was read but the CRC is not good
+  return <0 with another error code if there is an error. The file must then
+    be closed (and may be reopened for unzReadCurrentFile)
+*/
+
 extern z_off_t ZEXPORT unztell OF((unzFile file));
 
 extern ZPOS64_T ZEXPORT unztell64 OF((unzFile file));
@@ -0,0 +1,406 @@
+/* unzstream.c -- forward-only unzip for input that cannot seek, see unzstream.h
+*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "unzstream.h"
+
+#define UNZS_BUFSIZE (65536)
+
+#define UNZS_LOCAL_HEADER (0x04034b50)
+#define UNZS_DATA_DESCRIPTOR (0x08074b50)
+#define UNZS_CENTRAL_HEADER (0x02014b50)
+#define UNZS_END_OF_CENTRAL_DIR (0x06054b50)
+#define UNZS_ZIP64_END_OF_CENTRAL_DIR (0x06064b50)
+
+typedef struct
+{
+    unzs_read_func read_func;
+    voidpf opaque;
+    int fd;                     /* read by unzsOpen's read_func */
+    int close_fd;               /* fd was opened by unzsOpen */
+
+    unsigned char buf[UNZS_BUFSIZE]; /* input read ahead, [pos, end) unused */
+    uLong pos;
+    uLong end;
+    int eof;
+
+    /* the current file */
+    int in_file;                /* there is a current file */
+    int done;                   /* its data has been read completely */
+    uLong flag;                 /* general purpose bit flag */
+    uLong method;
+    int zip64;                  /* a zip64 extra field was present */
+    int size_known;             /* the compressed size in the header is valid */
+    ZPOS64_T rest_compressed;   /* if size_known */
+    uLong crc32;                /* of the data read so far */
+    uLong crc32_wait;           /* from the header, or from the data descriptor */
+    z_stream stream;
+    int stream_initialised;
+} unzs_s;
+
+
+static long ZCALLBACK unzs_read_fd (voidpf opaque, void* buf, uLong size)
+{
+    ssize_t n;
+    do
+        n = read(*(int*)opaque, buf, size);
+    while ((n < 0) && (errno == EINTR));
+    return (long)n;
+}
+
+/* makes at least n bytes (n <= UNZS_BUFSIZE) available at buf+pos. Returns 0 if the input ends before. */
+static int unzs_need (unzs_s* s, uLong n)
+{
+    if (s->end - s->pos >= n)
+        return 1;
+    if (s->pos > 0)
+    {
+        memmove(s->buf, s->buf + s->pos, s->end - s->pos);
+        s->end -= s->pos;
+        s->pos = 0;
+    }
+    while ((s->end < n) && !s->eof)
+    {
+        long got = s->read_func(s->opaque, s->buf + s->end, UNZS_BUFSIZE - s->end);
+        if (got <= 0)
+            s->eof = 1;
+        else
+            s->end += (uLong)got;
+    }
+    return s->end >= n;
+}
+
+/* discards n bytes of input. Returns 0 if the input ends before. */
+static int unzs_skip (unzs_s* s, ZPOS64_T n)
+{
+    while (n > 0)
+    {
+        uLong step = (uLong)(n < UNZS_BUFSIZE ? n : UNZS_BUFSIZE);
+        if (s->end - s->pos < step)
+            step = s->end - s->pos;
+        if ((step == 0) && !unzs_need(s, 1))
+            return 0;
+        s->pos += step;
+        n -= step;
+    }
+    return 1;
+}
+
+static uLong unzs_get16 (const unsigned char* p)
+{
+    return (uLong)p[0] | ((uLong)p[1] << 8);
+}
+
+static uLong unzs_get32 (const unsigned char* p)
+{
+    return unzs_get16(p) | (unzs_get16(p + 2) << 16);
+}
+
+static ZPOS64_T unzs_get64 (const unsigned char* p)
+{
+    return (ZPOS64_T)unzs_get32(p) | ((ZPOS64_T)unzs_get32(p + 4) << 32);
+}
+
+
+extern unzStream ZEXPORT unzsOpen2 (unzs_read_func read_func, voidpf opaque)
+{
+    unzs_s* s;
+    if (read_func == NULL)
+        return NULL;
+    s = (unzs_s*)malloc(sizeof(unzs_s));
+    if (s == NULL)
+        return NULL;
+    memset(s, 0, sizeof(unzs_s));
+    s->read_func = read_func;
+    s->opaque = opaque;
+    s->fd = -1;
+    s->close_fd = 0;
+    return (unzStream)s;
+}
+
+extern unzStream ZEXPORT unzsOpen (const char *path)
+{
+    unzs_s* s;
+    int fd;
+    if (path == NULL)
+        return NULL;
+    fd = strcmp(path, "-") == 0 ? STDIN_FILENO : open(path, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+    s = (unzs_s*)unzsOpen2(unzs_read_fd, NULL);
+    if (s == NULL)
+    {
+        if (fd != STDIN_FILENO)
+            close(fd);
+        return NULL;
+    }
+    s->fd = fd;
+    s->close_fd = fd != STDIN_FILENO;
+    s->opaque = (voidpf)&s->fd;
+    return (unzStream)s;
+}
+
+extern int ZEXPORT unzsClose (unzStream file)
+{
+    unzs_s* s = (unzs_s*)file;
+    int err = UNZ_OK;
+    if (s == NULL)
+        return UNZ_PARAMERROR;
+    if (s->stream_initialised)
+        inflateEnd(&s->stream);
+    if (s->close_fd && (close(s->fd) != 0))
+        err = UNZ_ERRNO;
+    free(s);
+    return err;
+}
+
+
+/* the current file is read completely: checks the CRC, from the data descriptor if there is one */
+static int unzs_end_of_file (unzs_s* s)
+{
+    s->done = 1;
+    if (s->flag & 8)
+    {
+        const uLong size_sizes = s->zip64 ? 16 : 8;
+        if (!unzs_need(s, 4))
+            return UNZ_BADZIPFILE;
+        if (unzs_get32(s->buf + s->pos) == UNZS_DATA_DESCRIPTOR) /* the signature is optional */
+            s->pos += 4;
+        if (!unzs_need(s, 4 + size_sizes))
+            return UNZ_BADZIPFILE;
+        s->crc32_wait = unzs_get32(s->buf + s->pos);
+        s->pos += 4 + size_sizes;
+    }
+    return s->crc32 == s->crc32_wait ? UNZ_OK : UNZ_CRCERROR;
+}
+
+extern int ZEXPORT unzsReadCurrentFile (unzStream file, voidp buf, unsigned len)
+{
+    unzs_s* s = (unzs_s*)file;
+    uInt n_out = 0;
+    if ((s == NULL) || !s->in_file || ((buf == NULL) && (len > 0)))
+        return UNZ_PARAMERROR;
+    if (s->done)
+        return 0;
+    if ((s->flag & 1) || ((s->method != 0) && (s->method != Z_DEFLATED)) || ((s->method == 0) && !s->size_known))
+        return UNZ_BADZIPFILE; /* encrypted, other method, STORED without size */
+    if (len > (uInt)-1 >> 1)
+        len = (uInt)-1 >> 1; /* the result is an int */
+
+    if (s->method == 0)
+    {
+        /* === STORED: copied from the read-ahead buffer === */
+        while ((n_out < len) && (s->rest_compressed > 0))
+        {
+            uLong step;
+            if ((s->pos == s->end) && !unzs_need(s, 1))
+                return UNZ_BADZIPFILE;
+            step = s->end - s->pos;
+            if (step > len - n_out)
+                step = len - n_out;
+            if (step > s->rest_compressed)
+                step = (uLong)s->rest_compressed;
+            memcpy((char*)buf + n_out, s->buf + s->pos, step);
+            s->crc32 = crc32(s->crc32, (const Bytef*)buf + n_out, (uInt)step);
+            s->pos += step;
+            s->rest_compressed -= step;
+            n_out += (uInt)step;
+        }
+        if (s->rest_compressed == 0)
+        {
+            int err = unzs_end_of_file(s);
+            if (err != UNZ_OK)
+                return err;
+        }
+        return (int)n_out;
+    }
+
+    /* === DEFLATED: inflated from the read-ahead buffer, which keeps what follows the deflate stream === */
+    s->stream.next_out = (Bytef*)buf;
+    s->stream.avail_out = len;
+    while (s->stream.avail_out > 0)
+    {
+        int err;
+        uLong n_in;
+        if ((s->pos == s->end) && !unzs_need(s, 1))
+            return UNZ_BADZIPFILE;
+        n_in = s->end - s->pos;
+        if (s->size_known && (n_in > s->rest_compressed))
+            n_in = (uLong)s->rest_compressed;
+        s->stream.next_in = s->buf + s->pos;
+        s->stream.avail_in = (uInt)n_in;
+        err = inflate(&s->stream, Z_SYNC_FLUSH);
+        n_in -= s->stream.avail_in;
+        s->pos += n_in;
+        if (s->size_known)
+            s->rest_compressed -= n_in;
+        if (err == Z_STREAM_END)
+        {
+            uInt n_new = len - s->stream.avail_out - n_out;
+            s->crc32 = crc32(s->crc32, (const Bytef*)buf + n_out, n_new);
+            n_out += n_new;
+            if (s->size_known && !unzs_skip(s, s->rest_compressed))
+                return UNZ_BADZIPFILE;
+            err = unzs_end_of_file(s);
+            if (err != UNZ_OK)
+                return err;
+            return (int)n_out;
+        }
+        if ((err != Z_OK) && (err != Z_BUF_ERROR))
+            return err == Z_MEM_ERROR ? UNZ_INTERNALERROR : UNZ_BADZIPFILE;
+        if (s->size_known && (s->rest_compressed == 0))
+            return UNZ_BADZIPFILE; /* the deflate stream goes beyond the size in the header */
+        {
+            uInt n_new = len - s->stream.avail_out - n_out;
+            s->crc32 = crc32(s->crc32, (const Bytef*)buf + n_out, n_new);
+            n_out += n_new;
+        }
+        if ((n_out > 0) && (s->pos == s->end))
+            break; /* pass on what there is rather than wait for more input */
+    }
+    return (int)n_out;
+}
+
+extern int ZEXPORT unzsGoToNextFile (unzStream file, char *szFileName, uLong fileNameBufferSize)
+{
+    unzs_s* s = (unzs_s*)file;
+    uLong signature, size_filename, size_extra;
+    ZPOS64_T compressed_size, uncompressed_size;
+    const unsigned char* h;
+    if (s == NULL)
+        return UNZ_PARAMERROR;
+
+    /* === the rest of the current file === */
+    if (s->in_file && !s->done)
+    {
+        if (!(s->flag & 1) && ((s->method == Z_DEFLATED) || ((s->method == 0) && s->size_known)))
+        {
+            /* read through, which also checks the CRC */
+            char scratch[16384];
+            int n;
+            while ((n = unzsReadCurrentFile(file, scratch, sizeof(scratch))) > 0)
+                ;
+            if (n < 0)
+                return n;
+        }
+        else if (!s->size_known || !unzs_skip(s, s->rest_compressed))
+            return UNZ_BADZIPFILE; /* the end of the data cannot be found */
+        else if ((s->flag & 8) && (unzs_end_of_file(s) == UNZ_BADZIPFILE))
+            return UNZ_BADZIPFILE; /* the CRC of unread data does not matter */
+    }
+    s->in_file = 0;
+
+    /* === local file header === */
+    if (!unzs_need(s, 4))
+        return UNZ_BADZIPFILE;
+    signature = unzs_get32(s->buf + s->pos);
+    if ((signature == UNZS_CENTRAL_HEADER) || (signature == UNZS_END_OF_CENTRAL_DIR) ||
+        (signature == UNZS_ZIP64_END_OF_CENTRAL_DIR))
+        return UNZ_END_OF_LIST_OF_FILE;
+    if ((signature != UNZS_LOCAL_HEADER) || !unzs_need(s, 30))
+        return UNZ_BADZIPFILE;
+    h = s->buf + s->pos;
+    s->flag = unzs_get16(h + 6);
+    s->method = unzs_get16(h + 8);
+    s->crc32_wait = unzs_get32(h + 14);
+    compressed_size = unzs_get32(h + 18);
+    uncompressed_size = unzs_get32(h + 22);
+    size_filename = unzs_get16(h + 26);
+    size_extra = unzs_get16(h + 28);
+    s->pos += 30;
+
+    /* === file name === */
+    if (!unzs_need(s, size_filename))
+        return UNZ_BADZIPFILE;
+    if ((szFileName != NULL) && (fileNameBufferSize > 0))
+    {
+        uLong n = size_filename < fileNameBufferSize - 1 ? size_filename : fileNameBufferSize - 1;
+        memcpy(szFileName, s->buf + s->pos, n);
+        szFileName[n] = '\0';
+    }
+    s->pos += size_filename;
+
+    /* === extra fields: the zip64 one has the sizes that are 0xFFFFFFFF in the header === */
+    s->zip64 = 0;
+    while (size_extra >= 4)
+    {
+        uLong id, size_data;
+        if (!unzs_need(s, 4))
+            return UNZ_BADZIPFILE;
+        id = unzs_get16(s->buf + s->pos);
+        size_data = unzs_get16(s->buf + s->pos + 2);
+        s->pos += 4;
+        size_extra -= 4;
+        if (size_data > size_extra)
+            return UNZ_BADZIPFILE;
+        if (!unzs_need(s, size_data))
+            return UNZ_BADZIPFILE;
+        if (id == 0x0001)
+        {
+            const unsigned char* p = s->buf + s->pos;
+            const unsigned char* p_end = p + size_data;
+            s->zip64 = 1;
+            if ((uncompressed_size == 0xffffffff) && (p + 8 <= p_end))
+            {
+                uncompressed_size = unzs_get64(p);
+                p += 8;
+            }
+            if ((compressed_size == 0xffffffff) && (p + 8 <= p_end))
+                compressed_size = unzs_get64(p);
+        }
+        s->pos += size_data;
+        size_extra -= size_data;
+    }
+    if (!unzs_skip(s, size_extra))
+        return UNZ_BADZIPFILE;
+    (void)uncompressed_size;
+
+    /* === with a data descriptor, the sizes in the header are usually 0 === */
+    s->size_known = !(s->flag & 8) || (compressed_size != 0);
+    s->rest_compressed = s->size_known ? compressed_size : 0;
+    s->crc32 = 0;
+    s->in_file = 1;
+    s->done = 0;
+    if ((s->method == Z_DEFLATED) && !(s->flag & 1))
+    {
+        int err;
+        if (s->stream_initialised)
+            err = inflateReset(&s->stream);
+        else
+        {
+            s->stream.zalloc = Z_NULL;
+            s->stream.zfree = Z_NULL;
+            s->stream.opaque = Z_NULL;
+            s->stream.next_in = Z_NULL;
+            s->stream.avail_in = 0;
+            err = inflateInit2(&s->stream, -MAX_WBITS);
+            s->stream_initialised = (err == Z_OK);
+        }
+        if (err != Z_OK)
+            return UNZ_INTERNALERROR;
+    }
+    else if ((s->method == 0) && s->size_known && (s->rest_compressed == 0))
+    {
+        int err = unzs_end_of_file(s); /* empty */
+        if (err != UNZ_OK)
+            return err;
+    }
+    return UNZ_OK;
+}
+
+extern int ZEXPORT unzsLocateFile (unzStream file, const char *szFileName, int iCaseSensitivity)
+{
+    char szCurrentFileName[256+1];
+    int err;
+    if ((file == NULL) || (szFileName == NULL))
+        return UNZ_PARAMERROR;
+    while ((err = unzsGoToNextFile(file, szCurrentFileName, sizeof(szCurrentFileName))) == UNZ_OK)
+        if (unzStringFileNameCompare(szCurrentFileName, szFileName, iCaseSensitivity) == 0)
+            return UNZ_OK;
+    return err;
+}
@@ -0,0 +1,71 @@
+/* unzstream.h -- forward-only unzip for input that cannot seek (pipes, stdin)
+   unzOpen needs the central directory at the end of the archive. This reader instead walks the local file
+   headers from the front, so a member can be inflated while the archive is still arriving.
+   Members whose sizes follow their data (data descriptor, general purpose bit 3) are supported when deflated,
+   since the deflate stream marks its own end; a STORED member needs its size in the local header.
+   Encrypted members and other compression methods can be skipped, if their size is known, but not read.
+*/
+
+#ifndef _ZLIBUNZSTREAM_H
+#define _ZLIBUNZSTREAM_H
+
+#include "unzip.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef voidp unzStream;
+
+/* reads up to size bytes into buf. Returns the number of bytes read, 0 at the end of the input, -1 on error */
+typedef long (ZCALLBACK *unzs_read_func) OF((voidpf opaque, void* buf, uLong size));
+
+/* Opens path for reading front to back, "-" for stdin. Returns NULL if failed. */
+extern unzStream ZEXPORT unzsOpen OF((const char *path));
+
+/* Same, reading with read_func(opaque, ...), e.g. from a socket */
+extern unzStream ZEXPORT unzsOpen2 OF((unzs_read_func read_func, voidpf opaque));
+
+/* Closes the reader, and the file opened by unzsOpen. Return UNZ_OK if there is no problem. */
+extern int ZEXPORT unzsClose OF((unzStream file));
+
+/*
+  Skip the rest of the current file, if any, and make the next one in the
+  archive the current file. Its name is copied to szFileName (if not NULL,
+  truncated to fileNameBufferSize-1 bytes and null terminated).
+  return UNZ_OK if there is no problem
+  return UNZ_END_OF_LIST_OF_FILE at the central directory (the end of the files)
+  return <0 with error code if there is an error, e.g. if the rest of the
+    current file cannot be skipped
+*/
+extern int ZEXPORT unzsGoToNextFile OF((unzStream file,
+                                        char *szFileName,
+                                        uLong fileNameBufferSize));
+
+/*
+  Skip files until szFileName. For the iCaseSensitivity signification, see
+  unzStringFileNameCompare. The files before it can no longer be read.
+  return UNZ_OK if the file is found. It becomes the current file.
+  return UNZ_END_OF_LIST_OF_FILE if the file is not found
+*/
+extern int ZEXPORT unzsLocateFile OF((unzStream file,
+                                      const char *szFileName,
+                                      int iCaseSensitivity));
+
+/*
+  Read bytes from the current file, inflated.
+  return the number of bytes copied if some bytes are copied
+  return 0 at the end of the file. The CRC has been checked then.
+  return <0 with error code if there is an error
+    (UNZ_CRCERROR if the CRC is not good, UNZ_BADZIPFILE if the file cannot
+    be read this way, see above)
+*/
+extern int ZEXPORT unzsReadCurrentFile OF((unzStream file,
+                                           voidp buf,
+                                           unsigned len));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
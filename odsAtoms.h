@@ -0,0 +1,84 @@
+#ifndef ODS_ATOMS_H
+#define ODS_ATOMS_H
+
+// Ids ("atoms") for the ODF element and attribute names the converter looks at.
+// A name is resolved once, when its tag is tokenized; matching an element or attribute afterwards is an integer compare.
+
+#include <cstddef>
+#include <cstring>
+
+enum odsAtom_e {
+    ATOM_OTHER = 0,  // any other name
+    // === elements ===
+    ATOM_OFFICE_DOCUMENT_CONTENT,
+    ATOM_OFFICE_BODY,
+    ATOM_OFFICE_SPREADSHEET,
+    ATOM_TABLE_TABLE,
+    ATOM_TABLE_TABLE_ROW,
+    ATOM_TABLE_TABLE_CELL,
+    ATOM_TEXT_P,
+    ATOM_TEXT_SPAN,
+    // === attributes ===
+    ATOM_TABLE_NAME,
+    ATOM_TABLE_NUMBER_ROWS_REPEATED,
+    ATOM_TABLE_NUMBER_COLUMNS_REPEATED,
+    // cell value attributes. Consecutive, in this order (OdsSaxParser relies on it)
+    ATOM_OFFICE_VALUE_TYPE,
+    ATOM_OFFICE_VALUE,
+    ATOM_OFFICE_DATE_VALUE,
+    ATOM_OFFICE_TIME_VALUE,
+    ATOM_OFFICE_BOOLEAN_VALUE
+};
+
+// returns the atom of the "n" byte name at "name" (not null terminated). Signature as tinyxml2::XMLAtomizer.
+inline int odsAtom(const char* name, size_t n) {
+    // === the length selects the candidates, one memcmp decides ===
+    auto is = [&](const char* s) { return !memcmp(name, s, n); };
+    switch (n) {
+        case 6:
+            if (is("text:p")) return ATOM_TEXT_P;
+            break;
+        case 9:
+            if (is("text:span")) return ATOM_TEXT_SPAN;
+            break;
+        case 10:
+            if (is("table:name")) return ATOM_TABLE_NAME;
+            break;
+        case 11:
+            if (is("table:table")) return ATOM_TABLE_TABLE;
+            if (is("office:body")) return ATOM_OFFICE_BODY;
+            break;
+        case 12:
+            if (is("office:value")) return ATOM_OFFICE_VALUE;
+            break;
+        case 15:
+            if (is("table:table-row")) return ATOM_TABLE_TABLE_ROW;
+            break;
+        case 16:
+            if (is("table:table-cell")) return ATOM_TABLE_TABLE_CELL;
+            break;
+        case 17:
+            if (is("office:value-type")) return ATOM_OFFICE_VALUE_TYPE;
+            if (is("office:date-value")) return ATOM_OFFICE_DATE_VALUE;
+            if (is("office:time-value")) return ATOM_OFFICE_TIME_VALUE;
+            break;
+        case 18:
+            if (is("office:spreadsheet")) return ATOM_OFFICE_SPREADSHEET;
+            break;
+        case 20:
+            if (is("office:boolean-value")) return ATOM_OFFICE_BOOLEAN_VALUE;
+            break;
+        case 23:
+            if (is("office:document-content")) return ATOM_OFFICE_DOCUMENT_CONTENT;
+            break;
+        case 26:
+            if (is("table:number-rows-repeated")) return ATOM_TABLE_NUMBER_ROWS_REPEATED;
+            break;
+        case 29:
+            if (is("table:number-columns-repeated")) return ATOM_TABLE_NUMBER_COLUMNS_REPEATED;
+            break;
+    }
+    return ATOM_OTHER;
+}
+
+#endif
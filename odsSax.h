@@ -0,0 +1,677 @@
+#ifndef ODS_SAX_H
+#define ODS_SAX_H
+
+// Event-driven ("SAX style") traversal of content.xml.
+// Unlike the tinyxml2 DOM path, no document tree is built: content.xml is tokenized once, chunk by chunk,
+// and tables / rows / cells are reported to a handler as they are completed.
+// Memory use is bounded by the largest single token (tag or text run), not by the document size.
+
+#include <algorithm>
+#include <cstdlib>  // atol
+#include <cstring>  // memchr, memcmp
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "cellValue.h"
+#include "odsAtoms.h"
+#include "sheetFilter.h"
+#include "xmlScan.h"
+
+// receives table / row / cell events from OdsSaxParser, in document order
+class OdsSaxHandler {
+   public:
+    virtual ~OdsSaxHandler() {}
+    // table:table start tag, "name" is the table:name attribute
+    virtual void tableStart(const std::string& name) = 0;
+    virtual void tableEnd() = 0;
+    // table:table-row start tag, "nRowRep" from table:number-rows-repeated (default 1)
+    virtual void rowStart(size_t nRowRep) = 0;
+    virtual void rowEnd() = 0;
+    // completed table:table-cell. "text" is the plain text of its first text:p (empty if none), "value" from office:value-type
+    // and the matching value attribute, "nColRep" from table:number-columns-repeated
+    virtual void cell(const std::string& text, const TypedValue& value, size_t nColRep) = 0;
+};
+
+class OdsSaxParser {
+   public:
+    // where the parsed text starts: a complete content.xml, a fragment from inside office:spreadsheet (e.g. one table:table element)
+    // or a fragment from inside table:table (e.g. a run of table:table-row elements, reported without tableStart / tableEnd)
+    enum context_e { DOCUMENT,
+                     SPREADSHEET,
+                     TABLE };
+
+    // only tables selected by "filter" are reported, the others are skipped without tokenizing their content.
+    // Rows and cells outside "filter.range" are not reported either; reported positions are relative to the range.
+    explicit OdsSaxParser(OdsSaxHandler& handler, context_e context = DOCUMENT, const SheetFilter& filter = SheetFilter()) : h(handler), filter(filter) {
+        if (context == SPREADSHEET || context == TABLE) stack.push_back({0, K_SPREADSHEET, true});
+        if (context == TABLE) stack.push_back({0, K_TABLE, true});
+        baseDepth = stack.size();
+        seenTable = seenSelected = context == TABLE;
+    }
+
+    // parses the next piece of content.xml. Chunk boundaries may fall anywhere (inside tags, entities or UTF-8 sequences).
+    void feed(const char* data, size_t n) {
+        if (done) return;
+        if (carry.empty()) {
+            // === parse straight from the caller's buffer, keep only the incomplete tail ===
+            size_t nUsed = parse(data, data + n, /*final*/ false);
+            carry.assign(data + nUsed, n - nUsed);
+        } else {
+            carry.append(data, n);
+            size_t nUsed = parse(carry.data(), carry.data() + carry.size(), /*final*/ false);
+            carry.erase(0, nUsed);
+        }
+    }
+
+    // call after the last chunk. Throws if content.xml is truncated, contains no tables or none that is selected.
+    void finish() {
+        if (done) return;
+        size_t nUsed = parse(carry.data(), carry.data() + carry.size(), /*final*/ true);
+        carry.erase(0, nUsed);
+        if (!carry.empty() || stack.size() != baseDepth || skipDepth > 0) throw std::runtime_error("XML parse failed for content.xml: document is truncated");
+        if (!seenTable) throw std::runtime_error("document contains no tables!");
+        if (!seenSelected) throw std::runtime_error("no table matches the sheet selection");
+    }
+
+    // true once every selected table is complete (see SheetFilter::isExhausted): the rest of content.xml need not be read
+    bool isDone() const { return done; }
+
+   private:
+    // element roles, relative to the path office:document-content/office:body/office:spreadsheet/table:table/table:table-row/table:table-cell/text:p
+    enum kind_e { K_OTHER,
+                  K_DOC,
+                  K_BODY,
+                  K_SPREADSHEET,
+                  K_TABLE,
+                  K_ROW,
+                  K_CELL,
+                  K_TEXTP,
+                  K_SPAN };
+
+    struct openElem_t {
+        size_t nameBegin;  // in "names", up to the next element's nameBegin
+        kind_e kind;
+        bool hasChild;  // any child node seen yet (for text:span, only the first child counts)
+    };
+
+    // parses complete tokens in [begin, end). Returns the number of bytes consumed; an incomplete token at the end is left for the next call.
+    size_t parse(const char* begin, const char* end, bool final) {
+        const char* p = begin;
+        while (p < end) {
+            if (done) return end - begin;
+
+            // === inside content that is not reported ===
+            if (skipDepth > 0) {
+                p = skipContent(p, end, final);
+                if (skipDepth > 0) break;
+                continue;
+            }
+
+            // === character data ===
+            if (*p != '<') {
+                const char* q = (const char*)memchr(p, '<', end - p);
+                if (!q) {
+                    if (!final) break;
+                    q = end;
+                }
+                onText(p, q, /*isCData*/ false);
+                p = q;
+                continue;
+            }
+
+            // === markup: need enough bytes to tell "<![CDATA[" from the other token types ===
+            const size_t nAvail = end - p;
+            if (!final && nAvail < 9) break;
+            const char* q;
+            if (startsWith(p, end, "<!--")) {
+                q = findStr(p + 4, end, "-->");
+                if (!q) break;
+                onOtherNode();
+                p = q + 3;
+            } else if (startsWith(p, end, "<![CDATA[")) {
+                q = findStr(p + 9, end, "]]>");
+                if (!q) break;
+                onText(p + 9, q, /*isCData*/ true);
+                p = q + 3;
+            } else if (startsWith(p, end, "<?")) {
+                q = findStr(p + 2, end, "?>");
+                if (!q) break;
+                onOtherNode();
+                p = q + 2;
+            } else if (startsWith(p, end, "<!")) {
+                q = (const char*)memchr(p, '>', nAvail);
+                if (!q) break;
+                onOtherNode();
+                p = q + 1;
+            } else {
+                q = findTagEnd(p + 1, end);
+                if (!q) break;
+                onTag(p + 1, q);
+                p = q + 1;
+            }
+        }
+        if (final && p < end) throw std::runtime_error("XML parse failed for content.xml: unterminated markup");
+        return p - begin;
+    }
+
+    static bool startsWith(const char* p, const char* end, const char* s) {
+        const size_t n = strlen(s);
+        return (size_t)(end - p) >= n && !memcmp(p, s, n);
+    }
+
+    static const char* findStr(const char* p, const char* end, const char* s) {
+        const size_t n = strlen(s);
+        while (end - p >= (ptrdiff_t)n) {
+            p = (const char*)memchr(p, s[0], end - p - n + 1);
+            if (!p) return NULL;
+            if (!memcmp(p, s, n)) return p;
+            ++p;
+        }
+        return NULL;
+    }
+
+    // returns the position of the '>' closing a tag, skipping quoted attribute values, or NULL if incomplete
+    static const char* findTagEnd(const char* p, const char* end) {
+        while ((p = findAny(p, end, '>', '"', '\'', '>')) < end) {
+            if (*p == '>') return p;
+            p = (const char*)memchr(p + 1, *p, end - p - 1);
+            if (!p) return NULL;
+            ++p;
+        }
+        return NULL;
+    }
+
+    static bool isSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+    }
+
+    // starts skipping the rest of the innermost open element, which is named "tag" (e.g. a table that is not selected)
+    void skipRest(const char* tag) {
+        skipTag = tag;
+        skipDepth = 1;
+    }
+
+    // skips content up to and including the end tag of the element passed to skipRest(), then closes that element.
+    // Only '<' positions are looked at: comments and CDATA sections are stepped over, nested elements of the same name
+    // counted in "skipDepth", everything else passes unparsed. Returns where to continue.
+    // An incomplete token at the end is left for the next call.
+    const char* skipContent(const char* p, const char* end, bool final) {
+        const size_t nTag = strlen(skipTag);
+        while ((p = (const char*)memchr(p, '<', end - p))) {
+            if (!final && (size_t)(end - p) < nTag + 4) return p;  // the end tag and its delimiter may be cut
+            const char* q;
+            if (startsWith(p, end, "<!--")) {
+                q = findStr(p + 4, end, "-->");
+                if (!q) return p;
+                p = q + 3;
+                continue;
+            }
+            if (startsWith(p, end, "<![CDATA[")) {
+                q = findStr(p + 9, end, "]]>");
+                if (!q) return p;
+                p = q + 3;
+                continue;
+            }
+            const bool isEnd = end - p > 1 && p[1] == '/';
+            const char* n = p + (isEnd ? 2 : 1);
+            if ((size_t)(end - n) > nTag && !memcmp(n, skipTag, nTag) && (isSpace(n[nTag]) || n[nTag] == '/' || n[nTag] == '>')) {
+                q = findTagEnd(n, end);
+                if (!q) return p;
+                if (isEnd)
+                    --skipDepth;
+                else if (q[-1] != '/')
+                    ++skipDepth;
+                p = q + 1;
+                if (skipDepth == 0) {
+                    closeElem();
+                    return p;
+                }
+                continue;
+            }
+            ++p;
+        }
+        return end;
+    }
+
+    // appends "p..q" with entities resolved and line endings normalized (same rules as tinyxml2 StrPair::GetStr)
+    static void appendDecoded(std::string& out, const char* p, const char* q) {
+        while (p < q) {
+            const char c = *p;
+            if (c == '\r' || c == '\n') {
+                const char other = c == '\r' ? '\n' : '\r';
+                p += (p + 1 < q && p[1] == other) ? 2 : 1;
+                out += '\n';
+            } else if (c == '&') {
+                p = appendEntity(out, p, q);
+            } else {
+                const char* run = p;
+                p = findAny(p, q, '&', '\r', '\n', '&');
+                out.append(run, p - run);
+            }
+        }
+    }
+
+    // resolves the entity at p (pointing to '&'). Unknown entities are copied literally. Returns the position after it.
+    static const char* appendEntity(std::string& out, const char* p, const char* q) {
+        static const struct {
+            const char* pattern;
+            char value;
+        } entities[] = {{"quot;", '"'}, {"amp;", '&'}, {"apos;", '\''}, {"lt;", '<'}, {"gt;", '>'}};
+        for (const auto& e : entities)
+            if (startsWith(p + 1, q, e.pattern)) {
+                out += e.value;
+                return p + 1 + strlen(e.pattern);
+            }
+
+        if (p + 2 < q && p[1] == '#') {
+            const bool hex = p[2] == 'x';
+            const char* d = p + (hex ? 3 : 2);
+            unsigned long ucs = 0;
+            const char* digitsStart = d;
+            for (; d < q && *d != ';'; ++d) {
+                int v;
+                if (*d >= '0' && *d <= '9')
+                    v = *d - '0';
+                else if (hex && *d >= 'a' && *d <= 'f')
+                    v = *d - 'a' + 10;
+                else if (hex && *d >= 'A' && *d <= 'F')
+                    v = *d - 'A' + 10;
+                else
+                    break;
+                ucs = ucs * (hex ? 16 : 10) + v;
+                if (ucs > 0x10FFFF) break;
+            }
+            if (d < q && *d == ';' && d > digitsStart && ucs > 0 && ucs <= 0x10FFFF) {
+                appendUtf8(out, ucs);
+                return d + 1;
+            }
+        }
+        out += '&';
+        return p + 1;
+    }
+
+    static void appendUtf8(std::string& out, unsigned long ucs) {
+        if (ucs < 0x80) {
+            out += (char)ucs;
+        } else if (ucs < 0x800) {
+            out += (char)(0xC0 | (ucs >> 6));
+            out += (char)(0x80 | (ucs & 0x3F));
+        } else if (ucs < 0x10000) {
+            out += (char)(0xE0 | (ucs >> 12));
+            out += (char)(0x80 | ((ucs >> 6) & 0x3F));
+            out += (char)(0x80 | (ucs & 0x3F));
+        } else {
+            out += (char)(0xF0 | (ucs >> 18));
+            out += (char)(0x80 | ((ucs >> 12) & 0x3F));
+            out += (char)(0x80 | ((ucs >> 6) & 0x3F));
+            out += (char)(0x80 | (ucs & 0x3F));
+        }
+    }
+
+    // character data between tags. Whitespace-only runs are not text nodes (tinyxml2 drops them), CDATA always is.
+    void onText(const char* p, const char* q, bool isCData) {
+        if (!isCData) {
+            const char* s = p;
+            while (s < q && isSpace(*s)) ++s;
+            if (s == q) return;
+        }
+        if (stack.empty()) return;
+        openElem_t& parent = stack.back();
+        const bool isFirstChild = !parent.hasChild;
+        parent.hasChild = true;
+        if (parent.kind == K_TEXTP || (parent.kind == K_SPAN && isFirstChild))
+            appendDecoded(cellText, p, q);
+    }
+
+    // comment, processing instruction or DTD: counts as a child node but carries no text
+    void onOtherNode() {
+        if (!stack.empty()) stack.back().hasChild = true;
+    }
+
+    // tag content between '<' and '>'
+    void onTag(const char* p, const char* q) {
+        if (p < q && *p == '/') {
+            // === end tag ===
+            const char* n = p + 1;
+            const char* ne = n;
+            while (ne < q && !isSpace(*ne)) ++ne;
+            if (stack.size() <= baseDepth || names.compare(stack.back().nameBegin, std::string::npos, n, ne - n) != 0)
+                throw std::runtime_error("XML parse failed for content.xml: mismatched end tag '" + std::string(n, ne) + "'");
+            closeElem();
+            return;
+        }
+
+        // === start tag or empty-element tag ===
+        const bool selfClosing = q > p && q[-1] == '/';
+        if (selfClosing) --q;
+        const char* ne = p;
+        while (ne < q && !isSpace(*ne) && *ne != '/') ++ne;
+        if (ne == p) throw std::runtime_error("XML parse failed for content.xml: tag without name");
+
+        kind_e parentKind = K_OTHER;
+        if (!stack.empty()) {
+            stack.back().hasChild = true;
+            parentKind = stack.back().kind;
+        }
+        const int atom = odsAtom(p, ne - p);
+        kind_e kind = K_OTHER;
+        if (stack.empty() && atom == ATOM_OFFICE_DOCUMENT_CONTENT)
+            kind = K_DOC;
+        else if (parentKind == K_DOC && atom == ATOM_OFFICE_BODY)
+            kind = K_BODY;
+        else if (parentKind == K_BODY && atom == ATOM_OFFICE_SPREADSHEET)
+            kind = K_SPREADSHEET;
+        else if (parentKind == K_SPREADSHEET && atom == ATOM_TABLE_TABLE)
+            kind = K_TABLE;
+        else if (parentKind == K_TABLE && atom == ATOM_TABLE_TABLE_ROW)
+            kind = K_ROW;
+        else if (parentKind == K_ROW && atom == ATOM_TABLE_TABLE_CELL)
+            kind = K_CELL;
+        else if (parentKind == K_CELL && atom == ATOM_TEXT_P)
+            kind = K_TEXTP;
+        else if (parentKind == K_TEXTP && atom == ATOM_TEXT_SPAN)
+            kind = K_SPAN;
+        stack.push_back({names.size(), kind, false});
+        names.append(p, ne - p);
+
+        switch (kind) {
+            case K_TABLE: {
+                std::string tname;
+                if (!getAttribute(ne, q, ATOM_TABLE_NAME, tname)) throw std::runtime_error("no table name");
+                seenTable = true;
+                if (!filter.selects(tname, nTables++)) {
+                    // === not selected: not reported, content skipped ===
+                    stack.back().kind = K_OTHER;
+                    if (!selfClosing) skipRest("table:table");
+                    break;
+                }
+                seenSelected = true;
+                if (filter.isNamed(tname)) ++nNamed;
+                ixRow = 0;
+                h.tableStart(tname);
+                break;
+            }
+            case K_ROW: {
+                std::string v;
+                const size_t nRowRep = getAttribute(ne, q, ATOM_TABLE_NUMBER_ROWS_REPEATED, v) ? std::atol(v.c_str()) : 1;
+                const size_t first = ixRow;
+                ixRow += nRowRep;
+                if (first >= filter.range.rowEnd) {
+                    // === below the range: the rest of the table is not needed. Nor the rest of the document, after the last selected table ===
+                    dropElem();
+                    if (filter.isExhausted(nTables, nNamed))
+                        closeElem();  // sets "done"
+                    else
+                        skipRest("table:table");
+                    return;
+                }
+                const size_t nInRange = overlap(first, nRowRep, filter.range.rowBegin, filter.range.rowEnd);
+                if (nInRange == 0) {
+                    // === above the range ===
+                    stack.back().kind = K_OTHER;
+                    if (!selfClosing) skipRest("table:table-row");
+                    break;
+                }
+                ixCol = 0;
+                h.rowStart(nInRange);
+                break;
+            }
+            case K_CELL:
+                if (!onCellTag(ne, q)) {
+                    if (ixCol - nColRep >= filter.range.colEnd) {
+                        // === right of the range: the rest of the row is not needed ===
+                        dropElem();
+                        skipRest("table:table-row");
+                        return;
+                    }
+                    // === left of the range ===
+                    stack.back().kind = K_OTHER;
+                    if (!selfClosing) skipRest("table:table-cell");
+                }
+                break;
+            case K_TEXTP:
+                if (cellHasTextP) cellText += '\n';  // one text:p per line of the cell
+                cellHasTextP = true;
+                break;
+            default:
+                break;
+        }
+        if (selfClosing) closeElem();
+    }
+
+    // reads repetition and typed value from the attribute section [p, q) of a table:table-cell start tag, in one pass.
+    // Advances "ixCol" past the cell. Returns false if the cell lies outside the range (its value is then not decoded),
+    // else "nColRep" is the number of repetitions inside the range.
+    bool onCellTag(const char* p, const char* q) {
+        nColRep = 1;
+        const char* raw[5][2] = {};  // undecoded values of the cell value attributes, in "cellAttrs" order
+        const char *n, *ne, *v, *ve;
+        while (nextAttribute(p, q, n, ne, v, ve)) {
+            const int atom = odsAtom(n, ne - n);
+            if (atom == ATOM_TABLE_NUMBER_COLUMNS_REPEATED) {
+                std::string rep;
+                appendDecoded(rep, v, ve);
+                nColRep = std::atol(rep.c_str());
+            } else if (atom >= ATOM_OFFICE_VALUE_TYPE && atom <= ATOM_OFFICE_BOOLEAN_VALUE) {
+                raw[atom - ATOM_OFFICE_VALUE_TYPE][0] = v;
+                raw[atom - ATOM_OFFICE_VALUE_TYPE][1] = ve;
+            }
+        }
+        const size_t first = ixCol;
+        ixCol += nColRep;
+        const size_t nInRange = overlap(first, nColRep, filter.range.colBegin, filter.range.colEnd);
+        if (nInRange == 0 && nColRep > 0) return false;
+        nColRep = nInRange;
+
+        for (size_t ix = 0; ix < 5; ++ix) {
+            cellAttrs[ix].clear();
+            if (raw[ix][0]) appendDecoded(cellAttrs[ix], raw[ix][0], raw[ix][1]);
+        }
+        cellValue = makeTypedValue(cellAttrs[0], cellAttrs[1], cellAttrs[2], cellAttrs[3], cellAttrs[4]);
+        cellText.clear();
+        cellHasTextP = false;
+        return true;
+    }
+
+    // removes the element just opened, without closing it: its content is skipped along with the rest of its parent
+    void dropElem() {
+        names.resize(stack.back().nameBegin);
+        stack.pop_back();
+    }
+
+    void closeElem() {
+        switch (stack.back().kind) {
+            case K_TABLE:
+                h.tableEnd();
+                if (filter.isExhausted(nTables, nNamed)) done = true;
+                break;
+            case K_ROW:
+                h.rowEnd();
+                break;
+            case K_CELL:
+                h.cell(cellText, cellValue, nColRep);
+                break;
+            default:
+                break;
+        }
+        names.resize(stack.back().nameBegin);
+        stack.pop_back();
+    }
+
+   public:
+    // reads the next attribute from the attribute section [p, q) of a start tag: name [n, ne), raw value [v, ve).
+    // Advances "p" past it. Returns false at the end of the tag.
+    static bool nextAttribute(const char*& p, const char* q, const char*& n, const char*& ne, const char*& v, const char*& ve) {
+        while (p < q && isSpace(*p)) ++p;
+        n = p;
+        while (p < q && *p != '=' && !isSpace(*p)) ++p;
+        ne = p;
+        while (p < q && isSpace(*p)) ++p;
+        if (p >= q || *p != '=') return false;  // malformed or end of tag
+        ++p;
+        while (p < q && isSpace(*p)) ++p;
+        if (p >= q || (*p != '"' && *p != '\'')) throw std::runtime_error("XML parse failed for content.xml: unquoted attribute value");
+        const char quote = *p++;
+        v = p;
+        p = (const char*)memchr(p, quote, q - p);
+        if (!p) throw std::runtime_error("XML parse failed for content.xml: unterminated attribute value");
+        ve = p++;
+        return true;
+    }
+
+    // looks up the attribute with atom "attrAtom" (see odsAtoms.h) in the attribute section [p, q) of a start tag. Returns false if not present.
+    static bool getAttribute(const char* p, const char* q, odsAtom_e attrAtom, std::string& value) {
+        const char *n, *ne, *v, *ve;
+        while (nextAttribute(p, q, n, ne, v, ve)) {
+            if (odsAtom(n, ne - n) == attrAtom) {
+                value.clear();
+                appendDecoded(value, v, ve);
+                return true;
+            }
+        }
+        return false;
+    }
+
+   private:
+    OdsSaxHandler& h;
+    const SheetFilter filter;
+    size_t nTables = 0;    // table:table elements seen, selected or not
+    size_t nNamed = 0;     // tables selected by name
+    size_t ixRow = 0;      // of the next row in the current table, counting repeated and skipped rows
+    size_t ixCol = 0;      // of the next cell in the current row
+    const char* skipTag = "";  // name of the element whose rest is skipped
+    size_t skipDepth = 0;      // > 0 while skipping, see skipRest()
+    bool done = false;         // see isDone()
+    std::string carry;  // unconsumed tail of the previous chunk
+    std::vector<openElem_t> stack;
+    std::string names;  // names of the open elements, back to back
+    size_t baseDepth;  // context elements assumed open before the first token
+    std::string cellText;
+    TypedValue cellValue;
+    std::string cellAttrs[5];  // office:value-type, office:value, office:date-value, office:time-value, office:boolean-value
+    size_t nColRep = 1;
+    bool cellHasTextP = false;
+    bool seenTable = false;
+    bool seenSelected = false;
+};
+
+/* Locates the table:table elements directly inside office:spreadsheet in a complete content.xml, without tokenizing.
+   Returns their byte ranges [begin, end), from '<' of the start tag to past the matching end tag.
+   Comments and CDATA sections are skipped; nested table:table elements stay inside their parent's range.
+*/
+inline std::vector<std::pair<size_t, size_t>> findTableSpans(const char* begin, const char* end) {
+    static const char tableTag[] = "table:table";
+    static const size_t nTableTag = sizeof(tableTag) - 1;
+    std::vector<std::pair<size_t, size_t>> r;
+    size_t depth = 0;
+    const char* tableStart = NULL;
+    const char* p = begin;
+    while ((p = (const char*)memchr(p, '<', end - p))) {
+        const char* q;
+        if (end - p >= 4 && !memcmp(p, "<!--", 4)) {
+            q = strstr(p + 4, "-->");  // content.xml is null terminated
+            if (!q) break;
+            p = q + 3;
+            continue;
+        }
+        if (end - p >= 9 && !memcmp(p, "<![CDATA[", 9)) {
+            q = strstr(p + 9, "]]>");
+            if (!q) break;
+            p = q + 3;
+            continue;
+        }
+        const bool isEnd = p + 1 < end && p[1] == '/';
+        const char* n = p + (isEnd ? 2 : 1);
+        // === table:table followed by a delimiter (not table:table-row etc) ===
+        if ((size_t)(end - n) > nTableTag && !memcmp(n, tableTag, nTableTag) && strchr(" \t\r\n/>", n[nTableTag])) {
+            q = n + nTableTag;
+            while (q < end && *q != '>') {
+                if (*q == '"' || *q == '\'') {
+                    q = (const char*)memchr(q + 1, *q, end - q - 1);
+                    if (!q) return r;
+                }
+                ++q;
+            }
+            if (q >= end) break;
+            const bool isEmpty = !isEnd && q[-1] == '/';
+            if (!isEnd && depth++ == 0) tableStart = p;
+            if ((isEnd || isEmpty) && depth > 0 && --depth == 0) r.push_back({tableStart - begin, q + 1 - begin});
+            p = q + 1;
+            continue;
+        }
+        ++p;
+    }
+    return r;
+}
+
+// returns the table:name of a table:table span (see findTableSpans) and sets "tagEnd" to the '>' of its start tag
+inline std::string tableSpanName(const char* begin, const char* end, const char*& tagEnd) {
+    tagEnd = begin + 1;
+    while (tagEnd < end && *tagEnd != '>') {
+        if (*tagEnd == '"' || *tagEnd == '\'') tagEnd = (const char*)memchr(tagEnd + 1, *tagEnd, end - tagEnd - 1);
+        if (!tagEnd) throw std::runtime_error("XML parse failed for content.xml: unterminated table:table tag");
+        ++tagEnd;
+    }
+    const bool isEmpty = tagEnd[-1] == '/';
+    const char* attrBegin = begin + 1 + strlen("table:table");
+    std::string name;
+    if (!OdsSaxParser::getAttribute(attrBegin, isEmpty ? tagEnd - 1 : tagEnd, ATOM_TABLE_NAME, name)) throw std::runtime_error("no table name");
+    return name;
+}
+
+// one table:table element prepared for parsing in pieces, see splitTableSpan()
+struct TableSplit {
+    std::string name;                                 // table:name
+    std::vector<std::pair<size_t, size_t>> pieces;  // [begin, end) of each piece of the table body, relative to the span
+};
+
+/* Splits a table:table span (see findTableSpans) into up to "nPieces" pieces of its body. Each piece starts at a
+   table:table-row start tag, so it can be parsed independently in the OdsSaxParser::TABLE context.
+   Returns a single piece if rows can't be told apart from the surrounding markup without tokenizing
+   (row groups, header rows, nested tables, comments, CDATA or processing instructions in the body).
+   Pieces are not made smaller than "minPieceSize" bytes.
+*/
+inline TableSplit splitTableSpan(const char* begin, const char* end, size_t nPieces, size_t minPieceSize) {
+    TableSplit r;
+    const char* tagEnd;
+    r.name = tableSpanName(begin, end, tagEnd);
+    if (tagEnd[-1] == '/') return r;  // empty-element tag
+
+    // === body: between the start tag and the end tag (the last '<' of the span) ===
+    const char* bodyBegin = tagEnd + 1;
+    const char* bodyEnd = end - 1;
+    while (bodyEnd > bodyBegin && *bodyEnd != '<') --bodyEnd;
+    const size_t bodyLen = bodyEnd - bodyBegin;
+
+    // === splitting is only safe if every "<table:table-row" is a direct child of the table. Single pass over the '<' positions ===
+    auto isDelimiter = [](char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '/' || c == '>'; };
+    bool safe = nPieces > 1 && bodyLen >= 2 * minPieceSize;
+    for (const char* p = bodyBegin; safe && (p = (const char*)memchr(p, '<', bodyEnd - p)); ++p) {
+        if (p[1] == '!' || p[1] == '?') safe = false;  // comment, CDATA, processing instruction
+        if (p[1] != 't' || memcmp(p + 1, "table:table", 11)) continue;
+        const char* suffix = p + 12;
+        if (isDelimiter(*suffix) || !memcmp(suffix, "-row-group", 10) || !memcmp(suffix, "-header-rows", 12) || (!memcmp(suffix, "-rows", 5) && isDelimiter(suffix[5])))
+            safe = false;
+    }
+    if (!safe) {
+        r.pieces.push_back({bodyBegin - begin, bodyEnd - begin});
+        return r;
+    }
+
+    // === cut near equidistant targets, at the next row start tag ===
+    if (bodyLen / nPieces < minPieceSize) nPieces = bodyLen / minPieceSize;
+    const char* pieceBegin = bodyBegin;
+    for (size_t ix = 1; ix < nPieces; ++ix) {
+        const char* p = std::max(bodyBegin + ix * (bodyLen / nPieces), pieceBegin + 1);
+        while ((p = (const char*)memchr(p, '<', bodyEnd - p)) && (memcmp(p + 1, "table:table-row", 15) || !isDelimiter(p[16])))
+            ++p;
+        if (!p) break;
+        r.pieces.push_back({pieceBegin - begin, p - begin});
+        pieceBegin = p;
+    }
+    r.pieces.push_back({pieceBegin - begin, bodyEnd - begin});
+    return r;
+}
+
+#endif
@@ -0,0 +1,132 @@
+#ifndef OUT_SINK_H
+#define OUT_SINK_H
+
+// Buffered byte output. Text is assembled in one large reusable buffer that goes out with a single write(2) per flush,
+// instead of one (synchronized) iostream call per token.
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class OutSink {
+   public:
+    // writes to the open file descriptor "fd", which stays open
+    explicit OutSink(int fd, size_t capacity = 1 << 20) : fd(fd), buf(capacity) {}
+
+    // creates (truncates) the file at "path" and writes to it. close() reports errors.
+    explicit OutSink(const std::string& path, size_t capacity = 1 << 20) : buf(capacity) {
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+        if (fd < 0) throw std::runtime_error("cannot create output file '" + path + "': " + strerror(errno));
+        ownsFd = true;
+    }
+
+    // appends everything to "*target", e.g. to hold output until it can be written in order. A pointer, so that a
+    // string cannot be mistaken for a path
+    explicit OutSink(std::string* target, size_t capacity = 1 << 16) : target(target), buf(capacity) {}
+
+    ~OutSink() {
+        try {
+            close();
+        } catch (const std::exception&) {
+            // === too late to report. Callers that care call close() ===
+        }
+    }
+
+    OutSink(const OutSink&) = delete;
+    OutSink& operator=(const OutSink&) = delete;
+
+    void put(char c) {
+        if (pos == buf.size()) flush();
+        buf[pos++] = c;
+    }
+
+    void put(std::string_view s) {
+        if (s.size() > buf.size() - pos) {
+            flush();
+            if (s.size() > buf.size()) {
+                // === larger than the buffer: bypass it ===
+                writeOut(s.data(), s.size());
+                return;
+            }
+        }
+        memcpy(&buf[pos], s.data(), s.size());
+        pos += s.size();
+    }
+
+    // "n" copies of "c", e.g. a run of empty cells
+    void fill(char c, size_t n) {
+        while (n > 0) {
+            if (pos == buf.size()) flush();
+            const size_t nNow = std::min(n, buf.size() - pos);
+            memset(&buf[pos], c, nNow);
+            pos += nNow;
+            n -= nNow;
+        }
+    }
+
+    // "n" copies of "s". Single characters take the memset path.
+    void repeat(std::string_view s, size_t n) {
+        if (s.size() == 1) {
+            fill(s[0], n);
+            return;
+        }
+        for (size_t ix = 0; ix < n; ++ix)
+            put(s);
+    }
+
+    // hands the buffered bytes to the file descriptor or target string. They are dropped if that fails.
+    void flush() {
+        if (pos == 0) return;
+        const size_t n = pos;
+        pos = 0;
+        writeOut(buf.data(), n);
+    }
+
+    // flushes, and closes the file descriptor if opened by the constructor
+    void close() {
+        if (!ownsFd) {
+            flush();
+            return;
+        }
+        ownsFd = false;
+        try {
+            flush();
+        } catch (...) {
+            ::close(fd);
+            throw;
+        }
+        if (::close(fd) != 0) throw std::runtime_error(std::string("close failed for output file: ") + strerror(errno));
+    }
+
+   protected:
+    void writeOut(const char* data, size_t n) {
+        if (target) {
+            target->append(data, n);
+            return;
+        }
+        while (n > 0) {
+            const ssize_t nWritten = ::write(fd, data, n);
+            if (nWritten < 0) {
+                if (errno == EINTR) continue;
+                throw std::runtime_error(std::string("write failed: ") + strerror(errno));
+            }
+            data += nWritten;
+            n -= nWritten;
+        }
+    }
+
+    int fd = -1;
+    bool ownsFd = false;
+    std::string* target = NULL;
+    std::vector<char> buf;
+    size_t pos = 0;  // bytes used in "buf"
+};
+
+#endif
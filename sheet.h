@@ -0,0 +1,170 @@
+#ifndef SHEET_H
+#define SHEET_H
+
+// Compact in-memory model of one spreadsheet table.
+// Rows are stored CSR style: per row run an index into flat per-cell arrays.
+// Cell texts are interned in a StringPool, which may be shared by all sheets of a workbook; cells hold 32-bit ids.
+// Each cell run keeps its typed value (see cellValue.h) next to the text id, 16 bytes together.
+// Repeated rows and cells (table:number-rows-repeated / table:number-columns-repeated) are stored once, as runs.
+// Only non-empty cells and rows with at least one non-empty cell are stored.
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "cellValue.h"
+#include "stringPool.h"
+
+class Sheet {
+   public:
+    explicit Sheet(std::shared_ptr<StringPool> pool = std::make_shared<StringPool>()) : pool(pool) {}
+
+    // === building: rows in ascending order, cells in ascending column order ===
+
+    // starts "nRep" identical rows at "ixRow"
+    void beginRow(size_t ixRow, size_t nRep) {
+        pendingIxRow = ixRow;
+        pendingNRep = nRep;
+    }
+
+    // adds "nRep" identical cells at column "ixCol" to the current row. "text" is the displayed text.
+    void addCell(size_t ixCol, size_t nRep, std::string_view text, const TypedValue& value = TypedValue()) {
+        if (ixCol > UINT32_MAX || nRep > UINT32_MAX) throw std::runtime_error("column index out of range");
+        cellCol.push_back(ixCol);
+        cellRep.push_back(nRep);
+        cells.push_back({value.num, pool->intern(text), value.type});
+    }
+
+    // completes the current row. Rows without cells are dropped.
+    void endRow() {
+        const size_t nCells = cellCol.size();
+        if (nCells == rowCellBegin.back()) return;
+        if (pendingNRep == 0) {
+            // === zero repetitions: discard the cells ===
+            const size_t nKeep = rowCellBegin.back();
+            cellCol.resize(nKeep);
+            cellRep.resize(nKeep);
+            cells.resize(nKeep);
+            return;
+        }
+        rowIx.push_back(pendingIxRow);
+        rowRep.push_back(pendingNRep);
+        rowCellBegin.push_back(nCells);
+    }
+
+    // appends all rows of "other", with row indices shifted by "rowOffset". Texts from a different pool are re-interned.
+    void append(const Sheet& other, size_t rowOffset) {
+        const size_t cellOffset = cellCol.size();
+        for (size_t ix = 0; ix < other.rowIx.size(); ++ix) {
+            rowIx.push_back(other.rowIx[ix] + rowOffset);
+            rowRep.push_back(other.rowRep[ix]);
+            rowCellBegin.push_back(other.rowCellBegin[ix + 1] + cellOffset);
+        }
+        cellCol.insert(cellCol.end(), other.cellCol.begin(), other.cellCol.end());
+        cellRep.insert(cellRep.end(), other.cellRep.begin(), other.cellRep.end());
+        if (other.pool == pool) {
+            cells.insert(cells.end(), other.cells.begin(), other.cells.end());
+            return;
+        }
+
+        // === map ids of "other" to ids in this pool, interning each referenced string once ===
+        std::vector<uint32_t> idMap(other.pool->size(), UINT32_MAX);
+        for (cell_t c : other.cells) {
+            if (idMap[c.textId] == UINT32_MAX) idMap[c.textId] = pool->intern(other.pool->get(c.textId));
+            c.textId = idMap[c.textId];
+            cells.push_back(c);
+        }
+    }
+
+    // removes all rows, keeping the allocated capacity. The pool is kept as well.
+    void clear() {
+        rowIx.clear();
+        rowRep.clear();
+        rowCellBegin.assign(1, 0);
+        cellCol.clear();
+        cellRep.clear();
+        cells.clear();
+    }
+
+    // === row runs ===
+    size_t nRowRuns() const { return rowIx.size(); }
+    size_t getIxRow(size_t ixRun) const { return rowIx[ixRun]; }
+    size_t getNRowRep(size_t ixRun) const { return rowRep[ixRun]; }
+    // cells of a row run are [cellBegin, cellEnd)
+    size_t cellBegin(size_t ixRun) const { return rowCellBegin[ixRun]; }
+    size_t cellEnd(size_t ixRun) const { return rowCellBegin[ixRun + 1]; }
+
+    // === cell runs ===
+    size_t getIxCol(size_t ixCell) const { return cellCol[ixCell]; }
+    size_t getNColRep(size_t ixCell) const { return cellRep[ixCell]; }
+    std::string_view getText(size_t ixCell) const { return pool->get(cells[ixCell].textId); }
+    uint32_t getTextId(size_t ixCell) const { return cells[ixCell].textId; }  // in getPool()
+    TypedValue getValue(size_t ixCell) const { return {cells[ixCell].type, cells[ixCell].num}; }
+
+    StringPool& getPool() const { return *pool; }
+
+    // === random access, like map lookup: text at (ixRow, ixCol), empty if the cell is empty ===
+    std::string_view at(size_t ixRow, size_t ixCol) const {
+        const size_t ixCell = find(ixRow, ixCol);
+        return ixCell == SIZE_MAX ? std::string_view() : getText(ixCell);
+    }
+
+    // typed value at (ixRow, ixCol), VT_STRING if the cell is empty
+    TypedValue valueAt(size_t ixRow, size_t ixCol) const {
+        const size_t ixCell = find(ixRow, ixCol);
+        return ixCell == SIZE_MAX ? TypedValue() : getValue(ixCell);
+    }
+
+    // cell run covering (ixRow, ixCol), SIZE_MAX if the cell is empty
+    size_t find(size_t ixRow, size_t ixCol) const {
+        // === last row run starting at or before ixRow ===
+        size_t lo = 0, hi = rowIx.size();
+        while (lo < hi) {
+            const size_t mid = (lo + hi) / 2;
+            if (rowIx[mid] <= ixRow)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        if (lo == 0 || ixRow >= rowIx[lo - 1] + rowRep[lo - 1]) return SIZE_MAX;
+        const size_t ixRun = lo - 1;
+
+        // === last cell run starting at or before ixCol ===
+        lo = cellBegin(ixRun);
+        hi = cellEnd(ixRun);
+        const size_t first = lo;
+        while (lo < hi) {
+            const size_t mid = (lo + hi) / 2;
+            if (cellCol[mid] <= ixCol)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        if (lo == first || ixCol >= (size_t)cellCol[lo - 1] + cellRep[lo - 1]) return SIZE_MAX;
+        return lo - 1;
+    }
+
+   protected:
+    std::vector<size_t> rowIx;
+    std::vector<size_t> rowRep;
+    std::vector<size_t> rowCellBegin = {0};  // one more entry than row runs
+    std::vector<uint32_t> cellCol;
+    std::vector<uint32_t> cellRep;
+    // === typed value and text of a cell run ===
+    struct cell_t {
+        double num;
+        uint32_t textId;  // in "pool"
+        valueType_e type;
+    };
+    static_assert(sizeof(cell_t) == 16, "cell_t should stay 16 bytes");
+
+    std::vector<cell_t> cells;
+    std::shared_ptr<StringPool> pool;
+    size_t pendingIxRow = 0;
+    size_t pendingNRep = 1;
+};
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef SHEET_FILTER_H
+#define SHEET_FILTER_H
+
+// Selection of the sheets (--sheet NAME, --sheet-index N) and of the cell range (--range A1:F5000) to convert.
+// Tables that are not selected are skipped before they are tokenized, so extracting one sheet costs about as much as
+// that sheet, plus a byte scan over the rest. Cells outside the range are never decoded.
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// rectangle of cells: rows [rowBegin, rowEnd) and columns [colBegin, colEnd), from 0
+struct CellRange {
+    size_t rowBegin = 0;
+    size_t rowEnd = SIZE_MAX;
+    size_t colBegin = 0;
+    size_t colEnd = SIZE_MAX;
+
+    // true if rows are restricted
+    bool hasRows() const { return rowBegin > 0 || rowEnd != SIZE_MAX; }
+
+    // parses spreadsheet notation, 1-based and inclusive: "A1:F5000" (cells), "A:F" (columns), "1:5000" (rows), "B3" (one cell)
+    static CellRange parse(const std::string& text) {
+        const std::runtime_error invalid("invalid range '" + text + "', expected e.g. A1:F5000, A:F or 1:5000");
+        const size_t ixColon = text.find(':');
+        const std::string first = text.substr(0, ixColon);
+        const std::string last = ixColon == std::string::npos ? first : text.substr(ixColon + 1);
+
+        // === corner: column letters and / or row digits ===
+        struct corner_t {
+            size_t ixCol = SIZE_MAX;
+            size_t ixRow = SIZE_MAX;
+        };
+        auto parseCorner = [&](const std::string& s) {
+            corner_t c;
+            size_t ix = 0;
+            size_t n = 0;
+            for (; ix < s.size() && ((s[ix] >= 'A' && s[ix] <= 'Z') || (s[ix] >= 'a' && s[ix] <= 'z')); ++ix) {
+                n = n * 26 + (s[ix] & 0x1F);  // 'A' and 'a' are 1
+                if (n > UINT32_MAX) throw invalid;
+            }
+            if (ix > 0) c.ixCol = n - 1;
+            n = 0;
+            const size_t ixDigits = ix;
+            for (; ix < s.size() && s[ix] >= '0' && s[ix] <= '9'; ++ix) {
+                n = n * 10 + (s[ix] - '0');
+                if (n > UINT32_MAX) throw invalid;
+            }
+            if (ix > ixDigits) {
+                if (n == 0) throw invalid;
+                c.ixRow = n - 1;
+            }
+            if (ix != s.size() || ix == 0) throw invalid;
+            return c;
+        };
+        const corner_t a = parseCorner(first);
+        const corner_t b = parseCorner(last);
+        if ((a.ixCol == SIZE_MAX) != (b.ixCol == SIZE_MAX) || (a.ixRow == SIZE_MAX) != (b.ixRow == SIZE_MAX)) throw invalid;
+
+        CellRange r;
+        if (a.ixCol != SIZE_MAX) {
+            r.colBegin = std::min(a.ixCol, b.ixCol);
+            r.colEnd = std::max(a.ixCol, b.ixCol) + 1;
+        }
+        if (a.ixRow != SIZE_MAX) {
+            r.rowBegin = std::min(a.ixRow, b.ixRow);
+            r.rowEnd = std::max(a.ixRow, b.ixRow) + 1;
+        }
+        return r;
+    }
+};
+
+// number of the "n" positions from "first" that lie in [begin, end)
+inline size_t overlap(size_t first, size_t n, size_t begin, size_t end) {
+    const size_t b = std::max(first, begin);
+    const size_t e = std::min(first + n, end);
+    return b < e ? e - b : 0;
+}
+
+struct SheetFilter {
+    std::vector<std::string> names;  // table:name values
+    std::vector<size_t> indices;     // positions in document order, counting from 1
+    CellRange range;                 // of each selected sheet. Its top left cell is output as A1.
+
+    // true if no sheet selection was made: every sheet is converted
+    bool all() const { return names.empty() && indices.empty(); }
+
+    // true if the table named "name" at position "ixTable" (from 0, document order) is to be converted
+    bool selects(std::string_view name, size_t ixTable) const {
+        return all() || isNamed(name) || std::find(indices.begin(), indices.end(), ixTable + 1) != indices.end();
+    }
+
+    // true if "name" is one of "names"
+    bool isNamed(std::string_view name) const { return std::find(names.begin(), names.end(), name) != names.end(); }
+
+    // true if no table after the first "nTables" can be selected, "nNamed" of which were selected by name
+    bool isExhausted(size_t nTables, size_t nNamed) const {
+        return !all() && nNamed >= names.size() && (indices.empty() || nTables >= *std::max_element(indices.begin(), indices.end()));
+    }
+};
+
+#endif
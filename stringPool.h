@@ -0,0 +1,85 @@
+#ifndef STRING_POOL_H
+#define STRING_POOL_H
+
+// Interned (deduplicated) strings with dense 32-bit ids.
+// Low-cardinality columns (currency codes, flags, categories) then store each distinct value once,
+// and cells refer to it by id. Ids are assigned in order of first appearance, starting at 0.
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class StringPool {
+   public:
+    StringPool() : slots(16, 0) {}
+
+    // returns the id of "s", adding it if not yet present
+    uint32_t intern(std::string_view s) {
+        const uint32_t h = (uint32_t)std::hash<std::string_view>()(s);
+        size_t ix = h & (slots.size() - 1);
+
+        // === linear probing. A slot holds id + 1, 0 is free ===
+        while (slots[ix]) {
+            const uint32_t id = slots[ix] - 1;
+            if (hashes[id] == h && get(id) == s) return id;
+            ix = (ix + 1) & (slots.size() - 1);
+        }
+        if (ends.size() >= UINT32_MAX - 1) throw std::runtime_error("too many distinct strings");
+        const uint32_t id = ends.size();
+        arena.append(s.data(), s.size());
+        ends.push_back(arena.size());
+        hashes.push_back(h);
+        slots[ix] = id + 1;
+        if (2 * ends.size() > slots.size()) rehash(2 * slots.size());
+        return id;
+    }
+
+    std::string_view get(uint32_t id) const {
+        const size_t begin = id ? ends[id - 1] : 0;
+        return std::string_view(arena.data() + begin, ends[id] - begin);
+    }
+
+    // number of distinct strings
+    size_t size() const { return ends.size(); }
+
+    // removes all strings, keeping the allocated capacity. Costs O(number of strings), not O(table size): a pool that
+    // is cleared per row must not pay for the widest row on every later one.
+    void clear() {
+        if (16 * ends.size() < slots.size()) {
+            // === few strings in a large table: free just their slots, found by probing from their hashes ===
+            for (uint32_t id = 0; id < ends.size(); ++id) {
+                size_t ix = hashes[id] & (slots.size() - 1);
+                while (slots[ix] != id + 1)
+                    ix = (ix + 1) & (slots.size() - 1);
+                slots[ix] = 0;
+            }
+        } else {
+            std::fill(slots.begin(), slots.end(), 0);
+        }
+        arena.clear();
+        ends.clear();
+        hashes.clear();
+    }
+
+   protected:
+    void rehash(size_t nSlots) {
+        slots.assign(nSlots, 0);
+        for (uint32_t id = 0; id < ends.size(); ++id) {
+            size_t ix = hashes[id] & (nSlots - 1);
+            while (slots[ix])
+                ix = (ix + 1) & (nSlots - 1);
+            slots[ix] = id + 1;
+        }
+    }
+
+    std::vector<uint32_t> slots;  // open addressing table, power of two size, at most half full
+    std::string arena;            // all strings, back to back
+    std::vector<size_t> ends;     // end of each string in "arena", the start is the end of the previous one
+    std::vector<uint32_t> hashes;
+};
+
+#endif
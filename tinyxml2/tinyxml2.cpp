@@ -362,6 +362,8 @@ const char* StrPair::GetStr()
                         }
                         if ( !entityFound ) {
                             // fixme: treat as error?
+                            // copy the '&': earlier entities may have moved the write pointer behind the read pointer
+                            *q = *p;
                             ++p;
                             ++q;
                         }
@@ -1574,6 +1576,7 @@ void XMLAttribute::SetAttribute( float v )
 // --------- XMLElement ---------- //
 XMLElement::XMLElement( XMLDocument* doc ) : XMLNode( doc ),
     _closingType( OPEN ),
+    _atom( 0 ),
     _rootAttribute( 0 )
 {
 }
@@ -1958,6 +1961,9 @@ char* XMLElement::ParseAttributes( char* p, int* curLineNumPtr )
                 _document->SetError( XML_ERROR_PARSING_ATTRIBUTE, attrLineNum, "XMLElement name=%s", Name() );
                 return 0;
             }
+            if ( _document->_atomizer ) {
+                attrib->_atom = attrib->_name.Atomize( _document->_atomizer );
+            }
             // There is a minor bug here: if the attribute in the source xml
             // document is duplicated, it will not be detected and the
             // attribute will be doubly added. However, tracking the 'prevAttribute'
@@ -2065,6 +2071,9 @@ char* XMLElement::ParseDeep( char* p, StrPair* parentEndTag, int* curLineNumPtr
     if ( _value.Empty() ) {
         return 0;
     }
+    if ( _document->_atomizer ) {
+        _atom = _value.Atomize( _document->_atomizer );
+    }
 
     p = ParseAttributes( p, curLineNumPtr );
     if ( !p || !*p || _closingType != OPEN ) {
@@ -2165,6 +2174,8 @@ XMLDocument::XMLDocument( bool processEntities, Whitespace whitespaceMode ) :
     _errorStr(),
     _errorLineNum( 0 ),
     _charBuffer( 0 ),
+    _charBufferAdopted( false ),
+    _atomizer( 0 ),
     _parseCurLineNum( 0 ),
 	_parsingDepth(0),
     _unlinked(),
@@ -2209,8 +2220,14 @@ void XMLDocument::Clear()
 #endif
     ClearError();
 
-    delete [] _charBuffer;
+    if ( _charBufferAdopted ) {
+        free( _charBuffer );
+    }
+    else {
+        delete [] _charBuffer;
+    }
     _charBuffer = 0;
+    _charBufferAdopted = false;
 	_parsingDepth = 0;
 
 #if 0
@@ -2451,6 +2468,36 @@ XMLError XMLDocument::Parse( const char* xml, size_t nBytes )
 }
 
 
+XMLError XMLDocument::ParseAdopt( char* xml, size_t nBytes )
+{
+    Clear();
+
+    if ( !xml ) {
+        SetError( XML_ERROR_EMPTY_DOCUMENT, 0, 0 );
+        return _errorID;
+    }
+    TIXMLASSERT( xml[nBytes] == 0 );
+    TIXMLASSERT( _charBuffer == 0 );
+    _charBuffer = xml;
+    _charBufferAdopted = true;
+    if ( nBytes == 0 || !*xml ) {
+        SetError( XML_ERROR_EMPTY_DOCUMENT, 0, 0 );
+        return _errorID;
+    }
+
+    Parse();
+    if ( Error() ) {
+        // see Parse( const char*, size_t )
+        DeleteChildren();
+        _elementPool.Clear();
+        _attributePool.Clear();
+        _textPool.Clear();
+        _commentPool.Clear();
+    }
+    return _errorID;
+}
+
+
 void XMLDocument::Print( XMLPrinter* streamer ) const
 {
     if ( streamer ) {
@@ -125,6 +125,13 @@ class XMLDeclaration;
 class XMLUnknown;
 class XMLPrinter;
 
+/*
+	Maps an element or attribute name (not null terminated) to a small
+	integer id, an "atom". 0 stands for names without an id.
+	See XMLDocument::SetAtomizer().
+*/
+typedef int (*XMLAtomizer)( const char* name, size_t length );
+
 /*
 	A class that wraps strings. Normally stores the start and end
 	pointers into the XML file itself, and will apply normalization
@@ -177,6 +184,11 @@ public:
     char* ParseText( char* in, const char* endTag, int strFlags, int* curLineNumPtr );
     char* ParseName( char* in );
 
+    // atom of the raw (unprocessed) string
+    int Atomize( XMLAtomizer atomizer ) const {
+        return atomizer( _start, _end - _start );
+    }
+
     void TransferTo( StrPair* other );
 	void Reset();
 
@@ -1150,6 +1162,9 @@ public:
     /// Gets the line number the attribute is in, if the document was parsed from a file.
     int GetLineNum() const { return _parseLineNum; }
 
+    /// Id of the name assigned while parsing, see XMLDocument::SetAtomizer(). 0 if none.
+    int Atom() const { return _atom; }
+
     /// The next attribute in the list.
     const XMLAttribute* Next() const {
         return _next;
@@ -1240,7 +1255,7 @@ public:
 private:
     enum { BUF_SIZE = 200 };
 
-    XMLAttribute() : _name(), _value(),_parseLineNum( 0 ), _next( 0 ), _memPool( 0 ) {}
+    XMLAttribute() : _name(), _value(),_parseLineNum( 0 ), _atom( 0 ), _next( 0 ), _memPool( 0 ) {}
     virtual ~XMLAttribute()	{}
 
     XMLAttribute( const XMLAttribute& );	// not supported
@@ -1252,6 +1267,7 @@ private:
     mutable StrPair _name;
     mutable StrPair _value;
     int             _parseLineNum;
+    int             _atom;
     XMLAttribute*   _next;
     MemPool*        _memPool;
 };
@@ -1274,6 +1290,11 @@ public:
         SetValue( str, staticMem );
     }
 
+    /// Id of the name assigned while parsing, see XMLDocument::SetAtomizer(). 0 if none.
+    int Atom() const {
+        return _atom;
+    }
+
     virtual XMLElement* ToElement()				{
         return this;
     }
@@ -1695,6 +1716,7 @@ private:
 
     enum { BUF_SIZE = 200 };
     ElementClosingType _closingType;
+    int _atom;
     // The attribute list is ordered; there is no 'lastAttribute'
     // because the list needs to be scanned for dupes before adding
     // a new attribute.
@@ -1749,6 +1771,26 @@ public:
     */
     XMLError Parse( const char* xml, size_t nBytes=static_cast<size_t>(-1) );
 
+    /**
+    	Parse an XML document in place, taking ownership of the
+    	buffer instead of copying it.
+    	'xml' must have been allocated with malloc(), hold nBytes+1
+    	bytes and be null terminated at xml[nBytes]. The document
+    	modifies it during parsing and free()s it on Clear() or
+    	destruction, also if parsing fails.
+    */
+    XMLError ParseAdopt( char* xml, size_t nBytes );
+
+    /**
+    	Elements and attributes parsed afterwards get the
+    	atom of their name from 'atomizer', see Atom(). Lets
+    	the caller match known names with an integer compare
+    	instead of a string compare. 0 (the default) turns it off.
+    */
+    void SetAtomizer( XMLAtomizer atomizer ) {
+        _atomizer = atomizer;
+    }
+
     /**
     	Load an XML file from disk.
     	Returns XML_SUCCESS (0) on success, or
@@ -1938,6 +1980,8 @@ private:
     mutable StrPair	_errorStr;
     int             _errorLineNum;
     char*			_charBuffer;
+    bool			_charBufferAdopted;	// from ParseAdopt(): release with free()
+    XMLAtomizer		_atomizer;
     int				_parseCurLineNum;
 	int				_parsingDepth;
 	// Memory tracking does add some overhead.
@@ -0,0 +1,81 @@
+#ifndef WORK_POOL_H
+#define WORK_POOL_H
+
+// Runs independent work items on a pool of threads while consuming the results in order.
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* Calls work(ix) for ix = 0 .. n-1 on up to "nWorkers" threads. On the calling thread, emit(ix) is called in ascending order,
+   as soon as work(ix) has finished and emit(ix-1) has returned.
+   At most 2 x nWorkers items are finished or in progress ahead of emit: a worker waits for the emitter before starting
+   work(ix) beyond that, so a slow consumer bounds the memory held by pending results.
+   An exception from work(ix) is rethrown on the calling thread in place of emit(ix); remaining items are then abandoned.
+*/
+inline void runOrdered(size_t n, size_t nWorkers, const std::function<void(size_t ix)>& work, const std::function<void(size_t ix)>& emit) {
+    std::vector<std::exception_ptr> errors(n);
+    std::vector<char> done(n, false);
+    std::mutex m;
+    std::condition_variable cvDone;
+    std::condition_variable cvEmitted;
+    std::atomic<size_t> ixNext(0);
+    std::atomic<bool> abandoned(false);
+    const size_t nThreads = std::max<size_t>(1, std::min(nWorkers, n));
+    const size_t nAhead = 2 * nThreads;
+    size_t nEmitted = 0;  // guarded by m
+
+    auto worker = [&] {
+        size_t ix;
+        while (!abandoned && (ix = ixNext++) < n) {
+            {
+                std::unique_lock<std::mutex> lock(m);
+                cvEmitted.wait(lock, [&] { return abandoned || ix < nEmitted + nAhead; });
+                if (abandoned) break;
+            }
+            try {
+                work(ix);
+            } catch (...) {
+                errors[ix] = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock(m);
+            done[ix] = true;
+            cvDone.notify_one();
+        }
+    };
+    std::vector<std::thread> workers;
+    for (size_t ix = 0; ix < nThreads; ++ix)
+        workers.emplace_back(worker);
+
+    // === consume in order. Workers must be joined before unwinding, they reference this stack frame ===
+    try {
+        for (size_t ix = 0; ix < n; ++ix) {
+            std::unique_lock<std::mutex> lock(m);
+            cvDone.wait(lock, [&] { return done[ix] != 0; });
+            lock.unlock();
+            if (errors[ix]) std::rethrow_exception(errors[ix]);
+            emit(ix);
+            lock.lock();
+            nEmitted = ix + 1;
+            cvEmitted.notify_all();
+        }
+    } catch (...) {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            abandoned = true;
+        }
+        cvEmitted.notify_all();
+        for (std::thread& t : workers)
+            t.join();
+        throw;
+    }
+    for (std::thread& t : workers)
+        t.join();
+}
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef XML_SCAN_H
+#define XML_SCAN_H
+
+// Byte scanning for the XML tokenizer: finds the first of up to four byte values (e.g. '<', '&', '"', '>'),
+// 16 bytes per step with SSE2 or 32 bytes per step with AVX2. The implementation is chosen once at startup
+// from the CPU's capabilities; other platforms use the scalar loop.
+
+#include <cstddef>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define XML_SCAN_X86
+#include <immintrin.h>
+#endif
+
+typedef const char* (*findAnyFun_t)(const char* p, const char* end, char a, char b, char c, char d);
+
+inline const char* findAnyScalar(const char* p, const char* end, char a, char b, char c, char d) {
+    for (; p < end; ++p) {
+        const char x = *p;
+        if (x == a || x == b || x == c || x == d) return p;
+    }
+    return end;
+}
+
+#ifdef XML_SCAN_X86
+__attribute__((target("sse2"))) inline const char* findAnySse2(const char* p, const char* end, char a, char b, char c, char d) {
+    const __m128i va = _mm_set1_epi8(a);
+    const __m128i vb = _mm_set1_epi8(b);
+    const __m128i vc = _mm_set1_epi8(c);
+    const __m128i vd = _mm_set1_epi8(d);
+    for (; end - p >= 16; p += 16) {
+        const __m128i v = _mm_loadu_si128((const __m128i*)p);
+        const __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, va), _mm_cmpeq_epi8(v, vb)),
+                                         _mm_or_si128(_mm_cmpeq_epi8(v, vc), _mm_cmpeq_epi8(v, vd)));
+        const int mask = _mm_movemask_epi8(hit);
+        if (mask) return p + __builtin_ctz(mask);
+    }
+    return findAnyScalar(p, end, a, b, c, d);
+}
+
+__attribute__((target("avx2"))) inline const char* findAnyAvx2(const char* p, const char* end, char a, char b, char c, char d) {
+    // === most tokenizer stops are close: look at the first 16 bytes before going 32 wide ===
+    if (end - p >= 16) {
+        const __m128i v = _mm_loadu_si128((const __m128i*)p);
+        const __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(a)), _mm_cmpeq_epi8(v, _mm_set1_epi8(b))),
+                                         _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(c)), _mm_cmpeq_epi8(v, _mm_set1_epi8(d))));
+        const int mask = _mm_movemask_epi8(hit);
+        if (mask) return p + __builtin_ctz(mask);
+        p += 16;
+    }
+    const __m256i va = _mm256_set1_epi8(a);
+    const __m256i vb = _mm256_set1_epi8(b);
+    const __m256i vc = _mm256_set1_epi8(c);
+    const __m256i vd = _mm256_set1_epi8(d);
+    for (; end - p >= 32; p += 32) {
+        const __m256i v = _mm256_loadu_si256((const __m256i*)p);
+        const __m256i hit = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, va), _mm256_cmpeq_epi8(v, vb)),
+                                            _mm256_or_si256(_mm256_cmpeq_epi8(v, vc), _mm256_cmpeq_epi8(v, vd)));
+        const unsigned mask = _mm256_movemask_epi8(hit);
+        if (mask) {
+            _mm256_zeroupper();
+            return p + __builtin_ctz(mask);
+        }
+    }
+    // === clean upper register halves: the SSE code of the caller would otherwise pay a state transition per instruction ===
+    _mm256_zeroupper();
+    return findAnySse2(p, end, a, b, c, d);
+}
+#endif
+
+// best implementation for this CPU
+inline findAnyFun_t selectFindAny() {
+#ifdef XML_SCAN_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return findAnyAvx2;
+    if (__builtin_cpu_supports("sse2")) return findAnySse2;
+#endif
+    return findAnyScalar;
+}
+
+// implementation used by findAny(). May be replaced, e.g. by benchmarks comparing the variants.
+inline findAnyFun_t findAnyImpl = selectFindAny();
+
+// returns the first position in [p, end) holding one of the bytes a, b, c, d (repeat one for fewer), or "end" if none
+inline const char* findAny(const char* p, const char* end, char a, char b, char c, char d) {
+    if (end - p < 16) return findAnyScalar(p, end, a, b, c, d);  // not worth a vector setup
+    return findAnyImpl(p, end, a, b, c, d);
+}
+
+#endif